@@ -0,0 +1,331 @@
+/**
+ * C++ example to demonstrate a compile-time capacity Array template
+ *
+ * The element type and the capacity are template parameters, so a
+ * StaticArray lives entirely on the stack (or in static storage) and
+ * never touches the heap. For trivial element types every operation is
+ * constexpr, which allows building lookup tables at compile time.
+ *
+ * Compile with: g++ -std=c++20 static_array.cpp
+ */
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+using namespace std;
+
+/**
+ * Storage of the array slots
+ *
+ * Trivial types are kept in a plain array that is left uninitialized,
+ * so the unused slots are never constructed and the whole storage is
+ * usable in constant expressions.
+ */
+template<class T, size_t N, bool Trivial = std::is_trivial<T>::value>
+struct ArrayStorage
+{
+    // Array data
+    T array[N];
+
+    constexpr T& at(size_t i) { return array[i]; }
+    constexpr const T& at(size_t i) const { return array[i]; }
+
+    // Construct the element at the given slot
+    constexpr void construct(size_t i, const T& element) { array[i] = element; }
+    constexpr void construct(size_t i, T&& element) { array[i] = std::move(element); }
+
+    // Destroy the element at the given slot (nothing to do)
+    constexpr void destroy(size_t) {}
+};
+
+/**
+ * Storage of the array slots for non-trivial types
+ *
+ * Raw aligned memory is used, and only the slots holding an element
+ * are constructed. These operations cannot be constexpr.
+ */
+template<class T, size_t N>
+struct ArrayStorage<T, N, false>
+{
+    // Raw memory for the array data
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+
+    T& at(size_t i) { return *std::launder(reinterpret_cast<T*>(bytes) + i); }
+    const T& at(size_t i) const { return *std::launder(reinterpret_cast<const T*>(bytes) + i); }
+
+    // Construct the element at the given slot
+    void construct(size_t i, const T& element) { new (reinterpret_cast<T*>(bytes) + i) T(element); }
+    void construct(size_t i, T&& element) { new (reinterpret_cast<T*>(bytes) + i) T(std::move(element)); }
+
+    // Destroy the element at the given slot
+    void destroy(size_t i) { at(i).~T(); }
+};
+
+/**
+ * Array implementation with compile-time capacity
+ */
+template<class T, size_t N>
+class StaticArray
+{
+    // Array data
+    ArrayStorage<T, N> storage;
+
+    // Size of the array
+    size_t size;
+
+public:
+    // Constructor
+    constexpr StaticArray() : size(0) {}
+
+    // Copy constructor, copying element by element into the used slots
+    constexpr StaticArray(const StaticArray& other) : size(0)
+    {
+        for (; size < other.size; ++size) {
+            storage.construct(size, other.storage.at(size));
+        }
+    }
+
+    // Move constructor, moving element by element
+    // The moved-from elements are still destroyed by the other array.
+    constexpr StaticArray(StaticArray&& other) : size(0)
+    {
+        for (; size < other.size; ++size) {
+            storage.construct(size, std::move(other.storage.at(size)));
+        }
+    }
+
+    // Copy assignment
+    constexpr StaticArray& operator=(const StaticArray& other)
+    {
+        if (this != &other) {
+            clear();
+            for (; size < other.size; ++size) {
+                storage.construct(size, other.storage.at(size));
+            }
+        }
+        return *this;
+    }
+
+    // Move assignment
+    constexpr StaticArray& operator=(StaticArray&& other)
+    {
+        if (this != &other) {
+            clear();
+            for (; size < other.size; ++size) {
+                storage.construct(size, std::move(other.storage.at(size)));
+            }
+        }
+        return *this;
+    }
+
+    // Destructor
+    constexpr ~StaticArray() { clear(); }
+
+    // Destroy all the elements
+    constexpr void clear()
+    {
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            for (size_t i=0; i < size; i++) {
+                storage.destroy(i);
+            }
+        }
+        size = 0;
+    }
+
+    // Insert an element into the given position
+    constexpr void insert_at(const T& element, size_t pos);
+
+    // Delete an element by the given position
+    constexpr void delete_at(size_t pos);
+
+    // Search the given element and return the position
+    // Returns the index if found, -1 otherwise.
+    constexpr int search(const T& element) const;
+
+    // Access the element at given position
+    // Returns the element
+    constexpr const T& get(size_t pos) const;
+
+    // Returns the number of elements
+    constexpr size_t length() const { return size; }
+
+    // Returns the maximum number of elements
+    static constexpr size_t capacity() { return N; }
+
+    // Traverse and print the elements
+    void traverse(const std::string& msg) const;
+};
+
+template<class T, size_t N>
+constexpr void StaticArray<T, N>::insert_at(const T& element, size_t pos)
+{
+    // Step 1. Check if the Array is full. If true, return error.
+    if (size >= N) {
+        throw std::runtime_error("array capacity reached");
+    }
+
+    // Step 2. Check if the given position is out of data range. If true, return error.
+    // Allow to insert at the end of array anyway.
+    if (pos > size) {
+        throw std::runtime_error("position out of insertion range");
+    }
+
+    // Step 3. Check if the new element goes at the end. If true, construct it there.
+    if (pos == size) {
+        storage.construct(size, element);
+        ++size;
+        return;
+    }
+
+    // Step 4. Copy the element first, it may refer into the array and be
+    // moved by the shifting below
+    T copy = element;
+
+    // Step 5. Free up the space for the new element by shifting the elements
+    // to next position. The last slot is unused, so construct it first.
+    storage.construct(size, std::move(storage.at(size-1)));
+    for (size_t i=size-1 ; i > pos ; --i) {
+        storage.at(i) = std::move(storage.at(i-1));
+    }
+
+    // Step 6. Insert the new element at the given position
+    storage.at(pos) = std::move(copy);
+
+    // Step 7. Increment the size by 1
+    ++size;
+}
+
+template<class T, size_t N>
+constexpr void StaticArray<T, N>::delete_at(size_t pos)
+{
+    // Step 1. Check if the given position is out of data range. If true, return error.
+    if (pos >= size) {
+        throw std::runtime_error("position out of data range");
+    }
+
+    // Step 2. Delete the element by shifting the elements to previous position.
+    for (size_t i=pos; i < (size-1); ++i) {
+        storage.at(i) = std::move(storage.at(i+1));
+    }
+
+    // Step 3. Destroy the last slot which is now unused
+    storage.destroy(size-1);
+
+    // Step 4. Decrement the size by 1
+    --size;
+}
+
+template<class T, size_t N>
+constexpr int StaticArray<T, N>::search(const T& element) const
+{
+    // Step 1. Traverse the array from the first position
+    for (size_t i=0; i < size; i++) {
+        // Step 2. Check if the element exists in the position. If true, return the position.
+        if (storage.at(i) == element) {
+            return static_cast<int>(i);
+        }
+    }
+    // Step 3. If the element is not found after the traversal, return -1
+    return -1;
+}
+
+template<class T, size_t N>
+constexpr const T& StaticArray<T, N>::get(size_t pos) const
+{
+    // Step 1. Check if the given position is out of array range. If true, return error.
+    if (pos >= size) {
+        throw std::runtime_error("position out of data range");
+    }
+
+    // Step 2. Return the element at the given position
+    return storage.at(pos);
+}
+
+template<class T, size_t N>
+void StaticArray<T, N>::traverse(const std::string& msg) const
+{
+    cout << msg << endl;
+    cout << "[";
+    for (size_t i=0; i < size; i++) {
+        cout << "  " << storage.at(i);
+    }
+    cout << "  ]" << endl;
+}
+
+// Build a table of squares at compile time
+// A constexpr variable must have every slot filled, so the table is used at full capacity.
+constexpr StaticArray<int, 8> make_squares()
+{
+    StaticArray<int, 8> table;
+    for (int i=0; i < 8; i++) {
+        table.insert_at(i * i, i);
+    }
+    return table;
+}
+
+int main()
+{
+    // Creating an Array of 10 integers
+    StaticArray<int, 10> arr;
+
+    // Insert elements
+    arr.insert_at(0, 0);
+    arr.traverse("Array after insert_at(0, 0)");
+    //==> [ 0 ]
+
+    arr.insert_at(10, 1);
+    arr.traverse("Array after insert_at(10, 1)");
+    //==> [ 0, 10 ]
+
+    arr.insert_at(20, 2);
+    arr.traverse("Array after insert_at(20, 2)");
+    //==> [ 0, 10, 20 ]
+
+    arr.insert_at(5, 1);
+    arr.traverse("Array after insert_at(5, 1)");
+    //==> [ 0, 5, 10, 20 ]
+
+    cout << "Access element at index 3 = " << arr.get(3) << endl;
+
+    cout << "Searching element 5 found at index = " << arr.search(5) << endl;
+
+    // Delete elements
+    arr.delete_at(1);
+    arr.traverse("Array after delete_at(1)");
+    //==> [ 0, 10, 20 ]
+
+    // Lookup table computed by the compiler
+    constexpr StaticArray<int, 8> squares = make_squares();
+    static_assert(squares.get(7) == 49, "squares computed at compile time");
+    static_assert(squares.search(25) == 5, "search evaluated at compile time");
+    squares.traverse("Compile-time table of squares");
+    //==> [ 0, 1, 4, 9, 16, 25, 36, 49 ]
+
+    // Array of non-trivial elements, only the used slots are constructed
+    StaticArray<std::string, 4> names;
+    names.insert_at("Bell", 0);
+    names.insert_at("Alice", 0);
+    names.insert_at("Max", 2);
+    names.traverse("Array of strings after inserting Bell, Alice and Max");
+    //==> [ Alice, Bell, Max ]
+
+    names.delete_at(0);
+    names.traverse("Array of strings after delete_at(0)");
+    //==> [ Bell, Max ]
+
+    // Copies own their elements, the original is left unchanged
+    StaticArray<std::string, 4> copy = names;
+    copy.insert_at(copy.get(0), 0);
+    copy.traverse("Copy after inserting its own first element at the front");
+    //==> [ Bell, Bell, Max ]
+    names.traverse("Original after the copy changed");
+    //==> [ Bell, Max ]
+
+    names = std::move(copy);
+    names.traverse("Original after move assignment from the copy");
+    //==> [ Bell, Bell, Max ]
+
+    return 0;
+}
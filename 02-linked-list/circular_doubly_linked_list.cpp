@@ -2,6 +2,7 @@
  * C++ example to demonstrate the circular doubly linked list
  */
 #include <iostream>
+#include "node_pool.h"
 using namespace std;
 
 // Linked list node representation
@@ -20,9 +21,16 @@ class CircularDoublyList
     // The first node of the list
     Node* head;
 
+    // Node pool to allocate from, or NULL to use new/delete
+    NodePool<Node>* pool;
+
 public:
     // Constructor
-    CircularDoublyList() : head(NULL) {}
+    // The nodes are allocated from the given pool if any
+    CircularDoublyList(NodePool<Node>* pool = NULL) : head(NULL), pool(pool) {}
+
+    // Destructor
+    ~CircularDoublyList();
 
     // Insert an element in front of the list
     // Returns the new node inserted
@@ -58,12 +66,58 @@ public:
     
     // Traverse the list and print the elements
     void traverse(const std::string& msg);
+
+private:
+    CircularDoublyList(const CircularDoublyList&);
+    CircularDoublyList& operator=(const CircularDoublyList&);
+
+    // Allocate a new node from the pool if available, with new otherwise
+    Node* create_node();
+
+    // Release the node to the pool if available, with delete otherwise
+    void destroy_node(Node* node);
 };
 
+CircularDoublyList::~CircularDoublyList()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (head == NULL) {
+        return;
+    }
+
+    // Step 2. Break the circle after the last node
+    Node* node = head;
+    head->prev->next = NULL;
+
+    // Step 3. Release the nodes one by one
+    while (node != NULL) {
+        Node* target = node;
+        node = node->next;
+        destroy_node(target);
+    }
+}
+
+Node* CircularDoublyList::create_node()
+{
+    if (pool != NULL) {
+        return pool->allocate();
+    }
+    return new Node();
+}
+
+void CircularDoublyList::destroy_node(Node* node)
+{
+    if (pool != NULL) {
+        pool->deallocate(node);
+        return;
+    }
+    delete node;
+}
+
 Node* CircularDoublyList::insert_front(int element)
 {
     // Step 1. Create the new node
-    Node* new_node = new Node();
+    Node* new_node = create_node();
     new_node->element = element;
 
     // Step 2. Check if the list is empty. If true, make the new node
@@ -90,7 +144,7 @@ Node* CircularDoublyList::insert_front(int element)
 Node* CircularDoublyList::insert_back(int element)
 {
     // Step 1. Create the new node
-    Node *new_node = new Node();
+    Node *new_node = create_node();
     new_node->element = element;
     
     // Step 2. Check if the list is empty. If true, make the new node
@@ -114,7 +168,7 @@ Node* CircularDoublyList::insert_back(int element)
 Node* CircularDoublyList::insert_after(Node* prev, int element)
 {
     // Step 1. Create the new node
-    Node *new_node = new Node();
+    Node *new_node = create_node();
     new_node->element = element;
 
     // Step 2. Link the new node after the given node
@@ -136,7 +190,7 @@ Node* CircularDoublyList::delete_front()
     // Step 2. Check if the list has single node. If true, delete the node,
     // reset the head to NULL, and return.
     if (head->next == head) {
-        delete head;
+        destroy_node(head);
         head = NULL;
         return NULL;
     }
@@ -152,7 +206,7 @@ Node* CircularDoublyList::delete_front()
     head = head->next;
     
     // Step 6. Delete the target node
-    delete target;
+    destroy_node(target);
     return head;
 }
 
@@ -166,7 +220,7 @@ Node* CircularDoublyList::delete_back()
     // Step 2. Check if the list has single node. If true, delete the node,
     // reset the head to NULL, and return.
     if (head->next == head) {
-        delete head;
+        destroy_node(head);
         head = NULL;
         return NULL;
     }
@@ -177,7 +231,7 @@ Node* CircularDoublyList::delete_back()
     target->next->prev = target->prev;
     
     // Step 4. Delete the target node
-    delete target;
+    destroy_node(target);
     return head->prev;
 }
 
@@ -201,7 +255,7 @@ Node* CircularDoublyList::delete_node(Node* target)
     
     // Step 4. Delete the target node
     Node* next_node = target->next;
-    delete target;
+    destroy_node(target);
     return next_node;
 }
 
@@ -231,7 +285,7 @@ bool CircularDoublyList::remove(int element)
             node->next->prev = node->prev;
             
             // Step 5. Delete the target node
-            delete target;
+            destroy_node(target);
             return true;
         }
     }
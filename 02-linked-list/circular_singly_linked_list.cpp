@@ -2,6 +2,7 @@
  * C++ example to demonstrate the circular linked list
  */
 #include <iostream>
+#include "node_pool.h"
 using namespace std;
 
 // Linked list node representation
@@ -20,9 +21,16 @@ class CircularList
     // The last->next contains the address of head node
     Node* last;
 
+    // Node pool to allocate from, or NULL to use new/delete
+    NodePool<Node>* pool;
+
 public:
     // Constructor
-    CircularList() : last(NULL) {}
+    // The nodes are allocated from the given pool if any
+    CircularList(NodePool<Node>* pool = NULL) : last(NULL), pool(pool) {}
+
+    // Destructor
+    ~CircularList();
 
     // Insert an element in front of the list
     // Returns the new node inserted
@@ -54,12 +62,58 @@ public:
     
     // Traverse the list and print the elements
     void traverse(const std::string& msg);
+
+private:
+    CircularList(const CircularList&);
+    CircularList& operator=(const CircularList&);
+
+    // Allocate a new node from the pool if available, with new otherwise
+    Node* create_node();
+
+    // Release the node to the pool if available, with delete otherwise
+    void destroy_node(Node* node);
 };
 
+CircularList::~CircularList()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (last == NULL) {
+        return;
+    }
+
+    // Step 2. Break the circle after the last node
+    Node* node = last->next;
+    last->next = NULL;
+
+    // Step 3. Release the nodes one by one
+    while (node != NULL) {
+        Node* target = node;
+        node = node->next;
+        destroy_node(target);
+    }
+}
+
+Node* CircularList::create_node()
+{
+    if (pool != NULL) {
+        return pool->allocate();
+    }
+    return new Node();
+}
+
+void CircularList::destroy_node(Node* node)
+{
+    if (pool != NULL) {
+        pool->deallocate(node);
+        return;
+    }
+    delete node;
+}
+
 Node* CircularList::insert_front(int element)
 {
     // Step 1. Create the new node
-    Node* new_node = new Node();
+    Node* new_node = create_node();
     new_node->element = element;
 
     // Step 2. Check if the list is empty. If true, make the new node
@@ -81,7 +135,7 @@ Node* CircularList::insert_front(int element)
 Node* CircularList::insert_back(int element)
 {
     // Step 1. Create the new node
-    Node *new_node = new Node();
+    Node *new_node = create_node();
     new_node->element = element;
     
     // Step 2. Check if the list is empty. If true, make the new node
@@ -105,7 +159,7 @@ Node* CircularList::insert_back(int element)
 Node* CircularList::insert_after(Node* prev, int element)
 {
     // Step 1. Create the new node
-    Node *new_node = new Node();
+    Node *new_node = create_node();
     new_node->element = element;
 
     // Step 2. Link the new node after the given node
@@ -125,7 +179,7 @@ Node* CircularList::delete_front()
     // Step 2. Check if the list has single node. If true, delete the node,
     // reset the last to NULL, and return.
     if (last->next == last) {
-        delete last;
+        destroy_node(last);
         last = NULL;
         return NULL;
     }
@@ -137,7 +191,7 @@ Node* CircularList::delete_front()
     last->next = last->next->next;
     
     // Step 5. Delete the target node
-    delete target;
+    destroy_node(target);
 
     return last->next;
 }
@@ -164,7 +218,7 @@ bool CircularList::delete_after(Node* prev)
     }
 
     // Step 4. Delete the target node
-    delete target;
+    destroy_node(target);
 
     return true;
 }
@@ -179,7 +233,7 @@ bool CircularList::remove(int element)
     // Step 2. Check if the list contains only node
     if (last == last->next) {
         if (last->element == element) {
-            delete last;
+            destroy_node(last);
             last = NULL;
             return true;
         }
@@ -203,7 +257,7 @@ bool CircularList::remove(int element)
             }
 
             // Step 6. Delete the target node
-            delete target;
+            destroy_node(target);
             return true;
         }
     }
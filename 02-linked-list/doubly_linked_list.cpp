@@ -1,15 +1,37 @@
 /**
  * C++ example to demonstrate the Doubly Linked List
  */
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "node_pool.h"
 using namespace std;
 
+struct Arena;
+
 // Linked list node representation
 struct Node
 {
     int element;
     Node* prev;
     Node* next;
+    Arena* arena; // Arena holding the node, NULL if not compacted
+};
+
+// Contiguous block of nodes filled by compact()
+// Nodes moved to another list by splicing keep their arena, so an arena is
+// freed by whichever list releases its last node.
+struct Arena
+{
+    Node* nodes;  // Node storage
+    int capacity; // Number of nodes in storage
+    int used;     // Number of nodes handed out
+    int live;     // Number of nodes still linked in a list
+    bool filling; // A compaction is still moving nodes into it
 };
 
 /**
@@ -20,9 +42,24 @@ class DoublyList
     // Head of the list
     Node* head;
 
+    // Node pool to allocate from, or NULL to use new/delete
+    NodePool<Node>* pool;
+
+    // Number of nodes in the list
+    int count;
+
+    // Compaction in progress: the arena being filled and the next node to move
+    Arena* compact_arena;
+    Node* compact_cursor;
+
 public:
     // Constructor
-    DoublyList() : head(NULL) {}
+    // The nodes are allocated from the given pool if any
+    DoublyList(NodePool<Node>* pool = NULL)
+        : head(NULL), pool(pool), count(0), compact_arena(NULL), compact_cursor(NULL) {}
+
+    // Destructor
+    ~DoublyList();
 
     // Insert an element in front of the list
     // Returns the new node inserted
@@ -61,12 +98,142 @@ public:
 
     // Print the elements
     void print(const std::string& msg);
+
+    // Move all the nodes into one contiguous arena in list order, so that
+    // traversals walk memory sequentially. The nodes change address: node
+    // pointers obtained before are no longer valid.
+    void compact();
+
+    // Perform a bounded slice of the compaction, moving at most max_nodes
+    // nodes into the arena, which is sized for the whole list by the first
+    // slice. The list can be used between slices, but every slice moves
+    // nodes: node pointers obtained before a call may dangle after it.
+    // Nodes inserted ahead of the cursor meanwhile are moved by the later
+    // slices while the arena has room.
+    // Returns true when the compaction is complete.
+    bool compact_step(int max_nodes);
+
+    // Sort the elements in ascending order, keeping equal elements in order
+    // Bottom-up merge sort: O(n log n), no recursion and no allocation.
+    void sort();
+
+    // Move the length nodes from first to last (inclusive) out of the other
+    // list, and link them after pos. A NULL pos links them at the front.
+    // O(1): the caller gives the length, so the range is not walked to keep
+    // the node counts, like std::list::splice between lists.
+    // Throws runtime_error if the lists use different node pools.
+    void splice_after(Node* pos, DoublyList& other, Node* first, Node* last, int length);
+
+    // Merge the sorted other list into this sorted list in linear time
+    // The other list becomes empty.
+    // Throws runtime_error if the lists use different node pools.
+    void merge(DoublyList& other);
+
+    // Benchmarks read the nodes directly
+    friend void benchmark_sort(int size);
+    friend void benchmark_splice_merge(int size);
+
+private:
+    DoublyList(const DoublyList&);
+    DoublyList& operator=(const DoublyList&);
+
+    // Allocate a new node from the pool if available, with new otherwise
+    Node* create_node();
+
+    // Remove the node from the count and release it, moving the
+    // compaction cursor away from it
+    void destroy_node(Node* node);
+
+    // Release the node to its arena, to the pool, or with delete
+    void release_node(Node* node);
+
+    // Stop the compaction in progress, if any, leaving the moved nodes
+    // in its arena
+    void end_compaction();
+
+    // Merge two sorted runs of nodes by their next links
+    // Returns the first node of the merged run
+    static Node* merge_runs(Node* a, Node* b);
+
+    // Rebuild the prev links from the next links
+    void fix_prev_links();
 };
 
+// Free an arena and its node storage
+static void free_arena(Arena* arena)
+{
+    ::operator delete(arena->nodes);
+    delete arena;
+}
+
+DoublyList::~DoublyList()
+{
+    // Release the nodes from front to end
+    while (head != NULL) {
+        Node* target = head;
+        head = head->next;
+        destroy_node(target);
+    }
+    end_compaction();
+}
+
+Node* DoublyList::create_node()
+{
+    count++;
+    Node* node = (pool != NULL) ? pool->allocate() : new Node();
+    node->arena = NULL;
+    return node;
+}
+
+void DoublyList::destroy_node(Node* node)
+{
+    count--;
+
+    // Keep the compaction cursor on a node which is still in the list
+    if (node == compact_cursor) {
+        compact_cursor = node->next;
+    }
+    release_node(node);
+}
+
+void DoublyList::release_node(Node* node)
+{
+    // Step 1. Check if the node lives in an arena. If true, free the
+    // arena once its last node is gone and no compaction fills it.
+    Arena* arena = node->arena;
+    if (arena != NULL) {
+        arena->live--;
+        if (arena->live == 0 && !arena->filling) {
+            free_arena(arena);
+        }
+        return;
+    }
+
+    // Step 2. Otherwise return it to the pool, or delete it
+    if (pool != NULL) {
+        pool->deallocate(node);
+        return;
+    }
+    delete node;
+}
+
+void DoublyList::end_compaction()
+{
+    if (compact_arena == NULL) {
+        return;
+    }
+    compact_arena->filling = false;
+    if (compact_arena->live == 0) {
+        free_arena(compact_arena);
+    }
+    compact_arena = NULL;
+    compact_cursor = NULL;
+}
+
 Node* DoublyList::insert_front(int element)
 {
     // Step 1. Create the new node
-    Node* new_node = new Node();
+    Node* new_node = create_node();
     new_node->element = element;
 
     // Step 2. Link the new node before the head node
@@ -85,7 +252,7 @@ Node* DoublyList::insert_front(int element)
 Node* DoublyList::insert_before(Node* next, int element)
 {
     // Step 1. Create the new node
-    Node *new_node = new Node();
+    Node *new_node = create_node();
     new_node->element = element;
 
     // Step 2. Link the new node before the given node
@@ -102,7 +269,7 @@ Node* DoublyList::insert_before(Node* next, int element)
 Node* DoublyList::insert_after(Node* prev, int element)
 {
     // Step 1. Create the new node
-    Node *new_node = new Node();
+    Node *new_node = create_node();
     new_node->element = element;
 
     // Step 2. Link the new node after the given node
@@ -146,7 +313,7 @@ Node* DoublyList::delete_front()
     }
 
     // Step 3. Delete the target node
-    delete target;
+    destroy_node(target);
 
     return head;
 }
@@ -168,7 +335,7 @@ Node* DoublyList::delete_node(Node* target)
     }
 
     // Step 3. Delete the target node
-    delete target;
+    destroy_node(target);
 
     return next;
 }
@@ -218,6 +385,195 @@ Node* DoublyList::search(int element)
     return NULL; // Not found
 }
 
+void DoublyList::compact()
+{
+    // Restart from the head, and move every node in one slice
+    end_compaction();
+    compact_step(count);
+}
+
+bool DoublyList::compact_step(int max_nodes)
+{
+    // Step 1. Check if a compaction is in progress. If not, start one
+    // with an arena large enough for every node of the list.
+    if (compact_arena == NULL) {
+        if (head == NULL) {
+            return true;
+        }
+        compact_arena = new Arena();
+        compact_arena->nodes = static_cast<Node*>(::operator new(count * sizeof(Node)));
+        compact_arena->capacity = count;
+        compact_arena->used = 0;
+        compact_arena->live = 0;
+        compact_arena->filling = true;
+        compact_cursor = head;
+    }
+
+    // Step 2. Move the nodes in list order into the next free arena slot,
+    // and rewire their neighbours to the new address.
+    for (int i=0; i < max_nodes && compact_cursor != NULL; i++) {
+        if (compact_arena->used == compact_arena->capacity) {
+            break;
+        }
+        Node* old_node = compact_cursor;
+        Node* new_node = new (&compact_arena->nodes[compact_arena->used++]) Node(*old_node);
+        new_node->arena = compact_arena;
+        compact_arena->live++;
+
+        if (new_node->prev != NULL) {
+            new_node->prev->next = new_node;
+        } else {
+            head = new_node;
+        }
+        if (new_node->next != NULL) {
+            new_node->next->prev = new_node;
+        }
+
+        compact_cursor = new_node->next;
+        release_node(old_node);
+    }
+
+    // Step 3. Check if every node was moved or the arena is full.
+    // If true, the compaction is complete.
+    if (compact_cursor != NULL && compact_arena->used < compact_arena->capacity) {
+        return false;
+    }
+    end_compaction();
+    return true;
+}
+
+Node* DoublyList::merge_runs(Node* a, Node* b)
+{
+    // Repeatedly link the smaller front node of both runs.
+    // On equal elements the node of the first run goes first.
+    Node* result = NULL;
+    Node** link = &result;
+    while (a != NULL && b != NULL) {
+        if (b->element < a->element) {
+            *link = b;
+            b = b->next;
+        } else {
+            *link = a;
+            a = a->next;
+        }
+        link = &(*link)->next;
+    }
+
+    // Link the rest of the run which is not exhausted
+    *link = (a != NULL) ? a : b;
+    return result;
+}
+
+void DoublyList::fix_prev_links()
+{
+    Node* prev = NULL;
+    for (Node* node = head; node != NULL; node = node->next) {
+        node->prev = prev;
+        prev = node;
+    }
+}
+
+void DoublyList::sort()
+{
+    // The nodes change order, so a compaction in progress cannot go on
+    end_compaction();
+
+    // bins[i] holds a sorted run of 2^i nodes, or NULL
+    Node* bins[64] = { NULL };
+    int bin_count = 0;
+
+    // Step 1. Take the nodes one by one from the front. Like a binary
+    // counter, merge the new node with the runs of bins 0, 1, 2, ...
+    // as long as they are occupied, then store the result in the first
+    // empty bin. Only the next links are maintained while merging.
+    while (head != NULL) {
+        Node* run = head;
+        head = head->next;
+        run->next = NULL;
+
+        int i = 0;
+        while (i < bin_count && bins[i] != NULL) {
+            // The older run goes first, so that the sort is stable
+            run = merge_runs(bins[i], run);
+            bins[i] = NULL;
+            i++;
+        }
+        bins[i] = run;
+        if (i == bin_count) {
+            bin_count++;
+        }
+    }
+
+    // Step 2. Merge the remaining runs, from the newest to the oldest
+    Node* result = NULL;
+    for (int i=0; i < bin_count; i++) {
+        if (bins[i] != NULL) {
+            result = merge_runs(bins[i], result);
+        }
+    }
+    head = result;
+
+    // Step 3. Restore the prev links in one pass
+    fix_prev_links();
+}
+
+void DoublyList::splice_after(Node* pos, DoublyList& other, Node* first, Node* last, int length)
+{
+    // Step 1. Check if both lists release their nodes the same way
+    if (pool != other.pool) {
+        throw std::runtime_error("lists use different node pools");
+    }
+
+    // Step 2. The compaction cursor of the other list may be in the range, stop it.
+    // Move the length of the range from one count to the other.
+    other.end_compaction();
+    other.count -= length;
+    count += length;
+
+    // Step 3. Detach the range from the other list
+    if (first->prev != NULL) {
+        first->prev->next = last->next;
+    } else {
+        other.head = last->next;
+    }
+    if (last->next != NULL) {
+        last->next->prev = first->prev;
+    }
+
+    // Step 4. Link the range after pos, or at the front
+    Node* next = (pos != NULL) ? pos->next : head;
+    first->prev = pos;
+    last->next = next;
+    if (pos != NULL) {
+        pos->next = first;
+    } else {
+        head = first;
+    }
+    if (next != NULL) {
+        next->prev = last;
+    }
+}
+
+void DoublyList::merge(DoublyList& other)
+{
+    // Step 1. Check if both lists release their nodes the same way
+    if (pool != other.pool) {
+        throw std::runtime_error("lists use different node pools");
+    }
+
+    // Step 2. Merge the nodes of both lists, and empty the other list.
+    // The nodes change order, so a compaction in progress cannot go on.
+    end_compaction();
+    other.end_compaction();
+    head = merge_runs(head, other.head);
+    count += other.count;
+    other.head = NULL;
+    other.count = 0;
+
+    // Step 3. Restore the prev links in one pass
+    fix_prev_links();
+}
+
 // Print the linked list
 void DoublyList::print(const std::string& msg)
 {
@@ -231,6 +587,157 @@ void DoublyList::print(const std::string& msg)
     cout << "NULL" << endl << endl;
 }
 
+// Measure the traversal time per element before and after compact()
+void benchmark_compact(int size)
+{
+    // Build a list whose order is unrelated to the allocation order,
+    // by inserting every element after a randomly chosen node
+    DoublyList list;
+    std::vector<Node*> nodes;
+    std::mt19937 rng(42);
+    nodes.push_back(list.insert_front(0));
+    for (int i=1; i < size; i++) {
+        nodes.push_back(list.insert_after(nodes[rng() % nodes.size()], i));
+    }
+
+    // Traverse the whole list by searching a missing element
+    auto traverse_ns = [&]() {
+        auto start = chrono::steady_clock::now();
+        Node* volatile found = NULL;
+        for (int r=0; r < 5; r++) {
+            found = list.search(-1);
+        }
+        (void)found;
+        return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / (5.0 * size);
+    };
+
+    double before = traverse_ns();
+
+    // Compact in slices of 64K nodes
+    int slices = 1;
+    while (!list.compact_step(65536)) {
+        slices++;
+    }
+    double after = traverse_ns();
+
+    cout << "Traversal of " << size << " nodes: " << before << " ns/element before compact(), "
+         << after << " ns/element after (" << slices << " slices)" << endl;
+}
+
+// Compare sort() against copying into a vector, sorting and rebuilding
+void benchmark_sort(int size)
+{
+    std::mt19937 rng(42);
+    std::vector<int> elements(size);
+    for (int i=0; i < size; i++) {
+        elements[i] = rng() % size;
+    }
+
+    // In-place merge sort
+    DoublyList list;
+    for (int i=0; i < size; i++) {
+        list.insert_front(elements[i]);
+    }
+    auto start = chrono::steady_clock::now();
+    list.sort();
+    double sort_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Copy into a vector, sort it, and rebuild the list
+    DoublyList copy;
+    for (int i=0; i < size; i++) {
+        copy.insert_front(elements[i]);
+    }
+    start = chrono::steady_clock::now();
+    std::vector<int> buffer;
+    buffer.reserve(size);
+    for (Node* node = copy.head; node != NULL; node = node->next) {
+        buffer.push_back(node->element);
+    }
+    while (copy.delete_front() != NULL) {
+    }
+    std::sort(buffer.begin(), buffer.end());
+    for (int i=size-1; i >= 0; i--) {
+        copy.insert_front(buffer[i]);
+    }
+    double copy_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "Sorting " << size << " elements: sort() " << sort_ms << " ms, copy-sort-rebuild "
+         << copy_ms << " ms" << endl;
+}
+
+// Compare splice_after() and merge() against copying the elements,
+// sorting them and rebuilding the lists
+void benchmark_splice_merge(int size)
+{
+    // Two sorted lists of size / 2 elements each
+    std::mt19937 rng(42);
+    std::vector<int> elements(size);
+    for (int i=0; i < size; i++) {
+        elements[i] = rng() % size;
+    }
+    int half = size / 2;
+    std::sort(elements.begin(), elements.begin() + half);
+    std::sort(elements.begin() + half, elements.end());
+    auto build = [&](DoublyList& list, int from, int to) {
+        for (int i=to-1; i >= from; i--) {
+            list.insert_front(elements[i]);
+        }
+    };
+
+    // Splice the front half of a into b, then merge b back into a
+    DoublyList a;
+    DoublyList b;
+    build(a, 0, half);
+    build(b, half, size);
+    Node* last = a.head;
+    for (int i=1; i < half / 2; i++) {
+        last = last->next;
+    }
+    auto start = chrono::steady_clock::now();
+    b.splice_after(NULL, a, a.head, last, half / 2);
+    double splice_us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    a.merge(b);
+    double merge_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // The same moves by copying: take the front half of c out into d, then
+    // copy c and d into a vector, sort it and rebuild c
+    DoublyList c;
+    DoublyList d;
+    build(c, 0, half);
+    build(d, half, size);
+    start = chrono::steady_clock::now();
+    std::vector<int> buffer;
+    for (int i=0; i < half / 2; i++) {
+        buffer.push_back(c.head->element);
+        c.delete_front();
+    }
+    for (int i=(int)buffer.size()-1; i >= 0; i--) {
+        d.insert_front(buffer[i]);
+    }
+    double copy_splice_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    buffer.clear();
+    buffer.reserve(size);
+    for (DoublyList* list : { &c, &d }) {
+        for (Node* node = list->head; node != NULL; node = node->next) {
+            buffer.push_back(node->element);
+        }
+        while (list->delete_front() != NULL) {
+        }
+    }
+    std::sort(buffer.begin(), buffer.end());
+    for (int i=size-1; i >= 0; i--) {
+        c.insert_front(buffer[i]);
+    }
+    double copy_merge_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "Splicing " << half / 2 << " elements: splice_after() " << splice_us << " us, copy "
+         << copy_splice_ms << " ms" << endl;
+    cout << "Merging two lists of " << half << " elements: merge() " << merge_ms << " ms, copy-sort-rebuild "
+         << copy_merge_ms << " ms" << endl;
+}
+
 int main()
 {
     // Create a linked list
@@ -266,4 +773,36 @@ int main()
 
     list.remove(20);
     list.print("remove(20)");
+
+    list.insert_back(50);
+    list.insert_back(60);
+    list.compact();
+    list.print("insert_back(50), insert_back(60) and compact()");
+
+    // Sort, splice and merge
+    DoublyList a;
+    DoublyList b;
+    for (int element : { 40, 10, 30, 20 }) {
+        a.insert_front(element);
+    }
+    for (int element : { 35, 5, 25 }) {
+        b.insert_front(element);
+    }
+    a.sort();
+    a.print("list a after sort()");
+    b.sort();
+    b.print("list b after sort()");
+
+    a.merge(b);
+    a.print("list a after a.merge(b)");
+
+    Node* node_20 = a.search(20);
+    Node* node_25 = a.search(25);
+    b.splice_after(NULL, a, node_20, node_25, 2);
+    a.print("list a after b.splice_after(NULL, a, node_20, node_25, 2)");
+    b.print("list b after b.splice_after(NULL, a, node_20, node_25, 2)");
+
+    benchmark_compact(1000000);
+    benchmark_sort(1000000);
+    benchmark_splice_merge(1000000);
 }
@@ -0,0 +1,682 @@
+/**
+ * C++ example to demonstrate the Index Linked Lists
+ *
+ * The singly and doubly lists below keep all of their nodes in one
+ * IndexPool and link them by 32-bit indices instead of pointers. A link
+ * takes 4 bytes instead of 8, nodes allocated in order sit next to each
+ * other in memory, and since no node holds an address, the whole list
+ * can be saved and restored with a single memcpy of its storage.
+ *
+ * Compile with: g++ -std=c++17 -O2 index_linked_list.cpp
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "index_pool.h"
+using namespace std;
+
+// Singly linked list node representation
+struct Node
+{
+    int element;
+    uint32_t next; // Index of the next node
+};
+
+/**
+ * Index based singly linked list implementation
+ */
+class IndexList
+{
+    // Node storage
+    IndexPool<Node> nodes;
+
+    // Index of the first node
+    uint32_t head;
+
+public:
+    // Index which refers to no node
+    static const uint32_t NIL = IndexPool<Node>::NIL;
+
+    // Constructor
+    IndexList() : head(NIL) {}
+
+    // Returns the index of the first node, NIL if empty
+    uint32_t front() const { return head; }
+
+    // Returns the index of the node after the given node
+    uint32_t next(uint32_t node) const { return nodes[node].next; }
+
+    // Returns the element of the given node
+    int& element(uint32_t node) { return nodes[node].element; }
+
+    // Insert an element in front of the list
+    // Returns the index of the new node
+    uint32_t insert_front(int element);
+
+    // Insert an element after the given node
+    // Returns the index of the new node
+    uint32_t insert_after(uint32_t prev, int element);
+
+    // Delete the front element
+    // Returns the index of the next node if available, NIL otherwise.
+    uint32_t delete_front();
+
+    // Delete the element after the given node
+    // Returns the index of the next node if available, NIL otherwise.
+    uint32_t delete_after(uint32_t prev);
+
+    // Search and delete the given element
+    void remove(int element);
+
+    // Search an element from the list
+    // Returns the index of the matching node if found, NIL otherwise.
+    uint32_t search(int element) const;
+
+    // Returns the number of elements
+    uint32_t size() const { return nodes.size(); }
+
+    // Append the raw image of the list to the buffer
+    void save(std::vector<unsigned char>& out) const;
+
+    // Replace the list by an image written by save()
+    // Returns the number of bytes read
+    // Throws runtime_error if the image is truncated
+    size_t load(const unsigned char* data, size_t size);
+
+    // Traverse the elements
+    void traverse(const std::string& msg) const;
+};
+
+uint32_t IndexList::insert_front(int element)
+{
+    // Step 1. Allocate the new node
+    uint32_t new_node = nodes.allocate();
+    nodes[new_node].element = element;
+
+    // Step 2. Link the new node in front of the head
+    nodes[new_node].next = head;
+    head = new_node;
+    return new_node;
+}
+
+uint32_t IndexList::insert_after(uint32_t prev, int element)
+{
+    // Step 1. Allocate the new node
+    // The pool may grow here, so prev is read again afterwards.
+    uint32_t new_node = nodes.allocate();
+    nodes[new_node].element = element;
+
+    // Step 2. Link the new node after prev
+    nodes[new_node].next = nodes[prev].next;
+    nodes[prev].next = new_node;
+    return new_node;
+}
+
+uint32_t IndexList::delete_front()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (head == NIL) {
+        return NIL;
+    }
+
+    // Step 2. Move the head to the next node and release the target
+    uint32_t target = head;
+    head = nodes[target].next;
+    nodes.deallocate(target);
+    return head;
+}
+
+uint32_t IndexList::delete_after(uint32_t prev)
+{
+    // Step 1. Check if there is a node after prev and return if not.
+    uint32_t target = nodes[prev].next;
+    if (target == NIL) {
+        return NIL;
+    }
+
+    // Step 2. Unlink the target and release it
+    nodes[prev].next = nodes[target].next;
+    nodes.deallocate(target);
+    return nodes[prev].next;
+}
+
+void IndexList::remove(int element)
+{
+    // Step 1. Iterate the list from start to end, remembering the previous node
+    uint32_t prev = NIL;
+    for (uint32_t node = head; node != NIL; node = nodes[node].next) {
+        // Step 2. Delete the node if it matches the element
+        if (nodes[node].element == element) {
+            if (prev == NIL) {
+                delete_front();
+            } else {
+                delete_after(prev);
+            }
+            return;
+        }
+        prev = node;
+    }
+}
+
+uint32_t IndexList::search(int element) const
+{
+    // Iterate the list from start to end
+    for (uint32_t node = head; node != NIL; node = nodes[node].next) {
+        if (nodes[node].element == element) {
+            return node; // Found element
+        }
+    }
+    return NIL; // Not found
+}
+
+void IndexList::save(std::vector<unsigned char>& out) const
+{
+    // The head index followed by the pool image
+    size_t offset = out.size();
+    out.resize(offset + sizeof(head));
+    std::memcpy(&out[offset], &head, sizeof(head));
+    nodes.save(out);
+}
+
+size_t IndexList::load(const unsigned char* data, size_t size)
+{
+    if (size < sizeof(head)) {
+        throw std::runtime_error("truncated list image");
+    }
+    size_t bytes = nodes.load(data + sizeof(head), size - sizeof(head));
+    std::memcpy(&head, data, sizeof(head));
+    return sizeof(head) + bytes;
+}
+
+void IndexList::traverse(const std::string& msg) const
+{
+    cout << msg << endl;
+    cout << "HEAD ==> ";
+    // Iterate the linked list from start to end
+    for (uint32_t node = head; node != NIL; node = nodes[node].next) {
+        cout << nodes[node].element << " ==> ";
+    }
+    cout << "NULL" << endl << endl;
+}
+
+// Doubly linked list node representation
+struct DoublyNode
+{
+    int element;
+    uint32_t prev; // Index of the previous node
+    uint32_t next; // Index of the next node
+};
+
+/**
+ * Index based doubly linked list implementation
+ */
+class IndexDoublyList
+{
+    // Node storage
+    IndexPool<DoublyNode> nodes;
+
+    // Index of the first and the last node
+    uint32_t head;
+    uint32_t tail;
+
+public:
+    // Index which refers to no node
+    static const uint32_t NIL = IndexPool<DoublyNode>::NIL;
+
+    // Constructor
+    IndexDoublyList() : head(NIL), tail(NIL) {}
+
+    // Returns the index of the first node, NIL if empty
+    uint32_t front() const { return head; }
+
+    // Returns the index of the last node, NIL if empty
+    uint32_t back() const { return tail; }
+
+    // Returns the index of the node after the given node
+    uint32_t next(uint32_t node) const { return nodes[node].next; }
+
+    // Returns the index of the node before the given node
+    uint32_t prev(uint32_t node) const { return nodes[node].prev; }
+
+    // Returns the element of the given node
+    int& element(uint32_t node) { return nodes[node].element; }
+
+    // Insert an element in front of the list
+    // Returns the index of the new node
+    uint32_t insert_front(int element);
+
+    // Insert an element at the end of the list
+    // Returns the index of the new node
+    uint32_t insert_back(int element);
+
+    // Insert an element before the given node
+    // Returns the index of the new node
+    uint32_t insert_before(uint32_t next, int element);
+
+    // Insert an element after the given node
+    // Returns the index of the new node
+    uint32_t insert_after(uint32_t prev, int element);
+
+    // Delete the front element
+    // Returns the index of the next node if available, NIL otherwise.
+    uint32_t delete_front();
+
+    // Delete the element from end of the list
+    // Returns the index of the previous node if available, NIL otherwise.
+    uint32_t delete_back();
+
+    // Delete the given node
+    // Returns the index of the next node if available, NIL otherwise.
+    uint32_t delete_node(uint32_t target);
+
+    // Search and delete the given element
+    void remove(int element);
+
+    // Search an element from the list
+    // Returns the index of the matching node if found, NIL otherwise.
+    uint32_t search(int element) const;
+
+    // Returns the number of elements
+    uint32_t size() const { return nodes.size(); }
+
+    // Append the raw image of the list to the buffer
+    void save(std::vector<unsigned char>& out) const;
+
+    // Replace the list by an image written by save()
+    // Returns the number of bytes read
+    // Throws runtime_error if the image is truncated
+    size_t load(const unsigned char* data, size_t size);
+
+    // Print the elements
+    void print(const std::string& msg) const;
+
+private:
+    // Allocate a node and link it between prev and next
+    uint32_t link_between(uint32_t prev, uint32_t next, int element);
+};
+
+uint32_t IndexDoublyList::link_between(uint32_t prev, uint32_t next, int element)
+{
+    // Step 1. Allocate the new node
+    uint32_t new_node = nodes.allocate();
+    nodes[new_node].element = element;
+    nodes[new_node].prev = prev;
+    nodes[new_node].next = next;
+
+    // Step 2. Point the neighbours, or the ends of the list, to the new node
+    if (prev == NIL) {
+        head = new_node;
+    } else {
+        nodes[prev].next = new_node;
+    }
+    if (next == NIL) {
+        tail = new_node;
+    } else {
+        nodes[next].prev = new_node;
+    }
+    return new_node;
+}
+
+uint32_t IndexDoublyList::insert_front(int element)
+{
+    return link_between(NIL, head, element);
+}
+
+uint32_t IndexDoublyList::insert_back(int element)
+{
+    return link_between(tail, NIL, element);
+}
+
+uint32_t IndexDoublyList::insert_before(uint32_t next, int element)
+{
+    return link_between(nodes[next].prev, next, element);
+}
+
+uint32_t IndexDoublyList::insert_after(uint32_t prev, int element)
+{
+    return link_between(prev, nodes[prev].next, element);
+}
+
+uint32_t IndexDoublyList::delete_front()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (head == NIL) {
+        return NIL;
+    }
+
+    // Step 2. Delete the first node
+    return delete_node(head);
+}
+
+uint32_t IndexDoublyList::delete_back()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (tail == NIL) {
+        return NIL;
+    }
+
+    // Step 2. Delete the last node and return the new last node
+    delete_node(tail);
+    return tail;
+}
+
+uint32_t IndexDoublyList::delete_node(uint32_t target)
+{
+    // Step 1. Link the neighbours, or the ends of the list, to each other
+    uint32_t prev = nodes[target].prev;
+    uint32_t next = nodes[target].next;
+    if (prev == NIL) {
+        head = next;
+    } else {
+        nodes[prev].next = next;
+    }
+    if (next == NIL) {
+        tail = prev;
+    } else {
+        nodes[next].prev = prev;
+    }
+
+    // Step 2. Release the target node
+    nodes.deallocate(target);
+    return next;
+}
+
+void IndexDoublyList::remove(int element)
+{
+    uint32_t target = search(element);
+    if (target != NIL) {
+        delete_node(target);
+    }
+}
+
+uint32_t IndexDoublyList::search(int element) const
+{
+    // Iterate the list from start to end
+    for (uint32_t node = head; node != NIL; node = nodes[node].next) {
+        if (nodes[node].element == element) {
+            return node; // Found element
+        }
+    }
+    return NIL; // Not found
+}
+
+void IndexDoublyList::save(std::vector<unsigned char>& out) const
+{
+    // The head and tail indices followed by the pool image
+    uint32_t ends[2] = { head, tail };
+    size_t offset = out.size();
+    out.resize(offset + sizeof(ends));
+    std::memcpy(&out[offset], ends, sizeof(ends));
+    nodes.save(out);
+}
+
+size_t IndexDoublyList::load(const unsigned char* data, size_t size)
+{
+    uint32_t ends[2];
+    if (size < sizeof(ends)) {
+        throw std::runtime_error("truncated list image");
+    }
+    size_t bytes = nodes.load(data + sizeof(ends), size - sizeof(ends));
+    std::memcpy(ends, data, sizeof(ends));
+    head = ends[0];
+    tail = ends[1];
+    return sizeof(ends) + bytes;
+}
+
+void IndexDoublyList::print(const std::string& msg) const
+{
+    cout << msg << endl;
+    cout << "HEAD --> ";
+    // Iterate the linked list from start to end
+    for (uint32_t node = head; node != NIL; node = nodes[node].next) {
+        cout << nodes[node].element;
+        cout << ((nodes[node].next == NIL)? " --> " : " <==> ");
+    }
+    cout << "NULL" << endl << endl;
+}
+
+// Pointer based singly linked list node, used for comparison
+struct ListNode
+{
+    int element;
+    ListNode* next;
+};
+
+// Pointer based doubly linked list node, used for comparison
+struct PointerNode
+{
+    int element;
+    PointerNode* prev;
+    PointerNode* next;
+};
+
+// Compare the index lists against pointer linked nodes
+// Each list is built by appending, then churned by deleting every other
+// node and appending as many again, so the free slots get reused.
+void benchmark(int size)
+{
+    // Singly: index list against singly linked pointer nodes
+    auto start = chrono::steady_clock::now();
+    ListNode* l_head = new ListNode{ 0, NULL };
+    ListNode* l_tail = l_head;
+    for (int i=1; i < size; i++) {
+        l_tail->next = new ListNode{ i, NULL };
+        l_tail = l_tail->next;
+    }
+    for (ListNode* node = l_head; node->next != NULL; node = node->next) {
+        ListNode* target = node->next;
+        node->next = target->next;
+        delete target;
+        if (node->next == NULL) {
+            l_tail = node;
+            break;
+        }
+    }
+    for (int i=0; i < size / 2; i++) {
+        l_tail->next = new ListNode{ i, NULL };
+        l_tail = l_tail->next;
+    }
+    double pointer_build = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    IndexList list;
+    uint32_t tail = list.insert_front(0);
+    for (int i=1; i < size; i++) {
+        tail = list.insert_after(tail, i);
+    }
+    for (uint32_t node = list.front(); list.next(node) != IndexList::NIL; node = list.next(node)) {
+        if (list.delete_after(node) == IndexList::NIL) {
+            tail = node;
+            break;
+        }
+    }
+    for (int i=0; i < size / 2; i++) {
+        tail = list.insert_after(tail, i);
+    }
+    double index_build = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    long long sum = 0;
+    start = chrono::steady_clock::now();
+    for (int round=0; round < 10; round++) {
+        for (ListNode* node = l_head; node != NULL; node = node->next) {
+            sum += node->element;
+        }
+    }
+    double pointer_traverse = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int round=0; round < 10; round++) {
+        for (uint32_t node = list.front(); node != IndexList::NIL; node = list.next(node)) {
+            sum -= list.element(node);
+        }
+    }
+    double index_traverse = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    while (l_head != NULL) {
+        ListNode* target = l_head;
+        l_head = l_head->next;
+        delete target;
+    }
+
+    cout << "Singly list with " << size << " appends, " << size / 2 << " deletes and " << size / 2
+         << " appends (checksum " << sum << ")" << endl;
+    cout << "  node size: pointer " << sizeof(ListNode) << " bytes + malloc header, index " << sizeof(Node) << " bytes" << endl;
+    cout << "  build: pointer " << pointer_build << " ms, IndexList " << index_build << " ms" << endl;
+    cout << "  10 traversals: pointer " << pointer_traverse << " ms, IndexList " << index_traverse << " ms" << endl;
+
+    // Doubly: index list against doubly linked pointer nodes
+    start = chrono::steady_clock::now();
+    PointerNode* p_head = NULL;
+    PointerNode* p_tail = NULL;
+    for (int i=0; i < size; i++) {
+        PointerNode* node = new PointerNode{ i, p_tail, NULL };
+        if (p_tail == NULL) {
+            p_head = node;
+        } else {
+            p_tail->next = node;
+        }
+        p_tail = node;
+    }
+    for (PointerNode* node = p_head; node != NULL && node->next != NULL; node = node->next) {
+        PointerNode* target = node->next;
+        node->next = target->next;
+        if (target->next == NULL) {
+            p_tail = node;
+        } else {
+            target->next->prev = node;
+        }
+        delete target;
+    }
+    for (int i=0; i < size / 2; i++) {
+        PointerNode* node = new PointerNode{ i, p_tail, NULL };
+        p_tail->next = node;
+        p_tail = node;
+    }
+    pointer_build = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    IndexDoublyList doubly;
+    for (int i=0; i < size; i++) {
+        doubly.insert_back(i);
+    }
+    for (uint32_t node = doubly.front(); node != IndexDoublyList::NIL && doubly.next(node) != IndexDoublyList::NIL;
+         node = doubly.next(node)) {
+        doubly.delete_node(doubly.next(node));
+    }
+    for (int i=0; i < size / 2; i++) {
+        doubly.insert_back(i);
+    }
+    index_build = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int round=0; round < 5; round++) {
+        for (PointerNode* node = p_head; node != NULL; node = node->next) {
+            sum += node->element;
+        }
+        for (PointerNode* node = p_tail; node != NULL; node = node->prev) {
+            sum += node->element;
+        }
+    }
+    pointer_traverse = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int round=0; round < 5; round++) {
+        for (uint32_t node = doubly.front(); node != IndexDoublyList::NIL; node = doubly.next(node)) {
+            sum -= doubly.element(node);
+        }
+        for (uint32_t node = doubly.back(); node != IndexDoublyList::NIL; node = doubly.prev(node)) {
+            sum -= doubly.element(node);
+        }
+    }
+    index_traverse = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Snapshot: deep copy of the pointer list against save() and load()
+    start = chrono::steady_clock::now();
+    PointerNode* c_head = NULL;
+    PointerNode* c_tail = NULL;
+    for (PointerNode* node = p_head; node != NULL; node = node->next) {
+        PointerNode* copy = new PointerNode{ node->element, c_tail, NULL };
+        if (c_tail == NULL) {
+            c_head = copy;
+        } else {
+            c_tail->next = copy;
+        }
+        c_tail = copy;
+    }
+    double pointer_copy = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    std::vector<unsigned char> image;
+    doubly.save(image);
+    IndexDoublyList restored;
+    restored.load(image.data(), image.size());
+    double index_copy = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    sum += restored.size() - doubly.size();
+
+    for (PointerNode* head : { p_head, c_head }) {
+        while (head != NULL) {
+            PointerNode* target = head;
+            head = head->next;
+            delete target;
+        }
+    }
+
+    cout << "Doubly list with the same operations (checksum " << sum << ")" << endl;
+    cout << "  node size: pointer " << sizeof(PointerNode) << " bytes + malloc header, index "
+         << sizeof(DoublyNode) << " bytes" << endl;
+    cout << "  build: pointer " << pointer_build << " ms, IndexDoublyList " << index_build << " ms" << endl;
+    cout << "  5 traversals both ways: pointer " << pointer_traverse << " ms, IndexDoublyList " << index_traverse << " ms" << endl;
+    cout << "  snapshot: pointer deep copy " << pointer_copy << " ms, IndexDoublyList save/load "
+         << index_copy << " ms (" << image.size() << " bytes)" << endl;
+}
+
+int main()
+{
+    // Create an index based singly linked list
+    IndexList list;
+    list.traverse("initial list");
+
+    // Insert elements
+    uint32_t node_10 = list.insert_front(10);
+    list.insert_after(node_10, 30);
+    list.insert_after(node_10, 20);
+    list.traverse("insert_front(10), insert_after(node_10, 30) and insert_after(node_10, 20)");
+
+    // Delete an element, its slot is reused by the next insert
+    list.remove(20);
+    list.traverse("remove(20)");
+    uint32_t node_30 = list.search(30);
+    cout << "insert_after(node_30, 40) reuses slot " << list.insert_after(node_30, 40) << endl;
+    list.traverse("insert_after(node_30, 40)");
+
+    // Create an index based doubly linked list
+    IndexDoublyList doubly;
+    doubly.insert_back(20);
+    uint32_t node_40 = doubly.insert_back(40);
+    doubly.insert_front(10);
+    doubly.insert_before(node_40, 30);
+    doubly.print("insert_back(20), insert_back(40), insert_front(10) and insert_before(node_40, 30)");
+
+    doubly.delete_front();
+    doubly.delete_back();
+    doubly.print("delete_front() and delete_back()");
+
+    // Snapshot the list twice into one buffer, and restore both into other lists
+    std::vector<unsigned char> image;
+    doubly.save(image);
+    doubly.insert_back(50);
+    doubly.save(image);
+    doubly.print("save(), insert_back(50) and save() again");
+
+    IndexDoublyList restored;
+    IndexDoublyList restored_later;
+    size_t offset = restored.load(image.data(), image.size());
+    restored_later.load(image.data() + offset, image.size() - offset);
+    restored.print("load() of the first image into another list");
+    restored_later.print("load() of the second image into another list");
+
+    benchmark(1000000);
+}
@@ -0,0 +1,143 @@
+/**
+ * Node pool addressed by 32-bit indices, used by the compact list examples
+ *
+ * All the nodes live in one contiguous vector and refer to each other by
+ * index instead of by pointer, so a link costs 4 bytes instead of 8 and
+ * the storage can grow, move or be copied as a whole. Index 0 is reserved
+ * as the NIL index. Freed slots are chained through their own memory and
+ * reused before the vector grows. Because the nodes hold no pointers, the
+ * whole pool can be saved and loaded back as one raw memory image.
+ */
+#ifndef INDEX_POOL_H
+#define INDEX_POOL_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+template<class T>
+class IndexPool
+{
+    static_assert(std::is_trivially_copyable<T>::value, "nodes must be trivially copyable");
+
+    // A free slot reuses the node memory to link the free list
+    union Slot
+    {
+        uint32_t next_free;
+        T node;
+    };
+
+    // Node storage, slots[0] is never handed out
+    std::vector<Slot> slots;
+
+    // First free slot, NIL if none
+    uint32_t free_head;
+
+    // Number of nodes handed out
+    uint32_t live;
+
+public:
+    // Index which refers to no node
+    static const uint32_t NIL = 0;
+
+    // Constructor
+    IndexPool() : slots(1), free_head(NIL), live(0) {}
+
+    // Reserve room for the given number of nodes
+    void reserve(size_t count) { slots.reserve(count + 1); }
+
+    // Allocate a value-initialized node
+    // Returns the index of the new node
+    // Throws runtime_error if all 32-bit indices are in use
+    uint32_t allocate();
+
+    // Return a node to the pool
+    void deallocate(uint32_t index);
+
+    // Returns the node at the given index
+    // The reference is invalidated by the next allocate()
+    T& operator[](uint32_t index) { return slots[index].node; }
+    const T& operator[](uint32_t index) const { return slots[index].node; }
+
+    // Returns the number of nodes handed out
+    uint32_t size() const { return live; }
+
+    // Returns the bytes of node storage in use, including free slots
+    size_t memory() const { return slots.capacity() * sizeof(Slot); }
+
+    // Append the raw image of the pool to the buffer
+    void save(std::vector<unsigned char>& out) const;
+
+    // Replace the pool by an image written by save()
+    // Returns the number of bytes read
+    // Throws runtime_error if the image is truncated
+    size_t load(const unsigned char* data, size_t size);
+};
+
+template<class T>
+uint32_t IndexPool<T>::allocate()
+{
+    // Step 1. Reuse the first free slot if any
+    uint32_t index = free_head;
+    if (index != NIL) {
+        free_head = slots[index].next_free;
+    } else {
+        // Step 2. Otherwise append a slot, as long as its index fits
+        if (slots.size() > UINT32_MAX) {
+            throw std::runtime_error("index pool is full");
+        }
+        index = (uint32_t)slots.size();
+        slots.emplace_back();
+    }
+
+    // Step 3. Initialize the node
+    slots[index].node = T();
+    live++;
+    return index;
+}
+
+template<class T>
+void IndexPool<T>::deallocate(uint32_t index)
+{
+    // Link the slot in front of the free list
+    slots[index].next_free = free_head;
+    free_head = index;
+    live--;
+}
+
+template<class T>
+void IndexPool<T>::save(std::vector<unsigned char>& out) const
+{
+    // Header: slot count, free list head and live count, then the slots as is
+    uint32_t header[3] = { (uint32_t)slots.size(), free_head, live };
+    size_t offset = out.size();
+    out.resize(offset + sizeof(header) + slots.size() * sizeof(Slot));
+    std::memcpy(&out[offset], header, sizeof(header));
+    std::memcpy(&out[offset + sizeof(header)], slots.data(), slots.size() * sizeof(Slot));
+}
+
+template<class T>
+size_t IndexPool<T>::load(const unsigned char* data, size_t size)
+{
+    // Step 1. Read the header
+    uint32_t header[3];
+    if (size < sizeof(header)) {
+        throw std::runtime_error("truncated pool image");
+    }
+    std::memcpy(header, data, sizeof(header));
+
+    // Step 2. Copy the slots back in one block
+    size_t bytes = header[0] * sizeof(Slot);
+    if (header[0] == 0 || size - sizeof(header) < bytes) {
+        throw std::runtime_error("truncated pool image");
+    }
+    slots.resize(header[0]);
+    std::memcpy(slots.data(), data + sizeof(header), bytes);
+    free_head = header[1];
+    live = header[2];
+    return sizeof(header) + bytes;
+}
+
+#endif // INDEX_POOL_H
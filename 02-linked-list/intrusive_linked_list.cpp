@@ -0,0 +1,664 @@
+/**
+ * C++ example to demonstrate the Intrusive Linked Lists
+ *
+ * The lists of this folder allocate their own node for every element.
+ * An intrusive list instead links the user objects directly: the object
+ * embeds a hook (the link fields), so inserting allocates nothing, and a
+ * doubly linked object can unlink itself in O(1) without any search.
+ * The list never owns the objects, the caller keeps them alive.
+ *
+ * Safe mode checks that an object is not inserted twice, and is unlinked
+ * only through the list it is linked in. It is enabled unless NDEBUG is
+ * defined, or can be set with -DINTRUSIVE_SAFE_MODE=0 / 1. Safe mode adds
+ * the owning list pointer to every hook.
+ *
+ * Compile with: g++ -std=c++17 -O2 intrusive_linked_list.cpp
+ */
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+using namespace std;
+
+#ifndef INTRUSIVE_SAFE_MODE
+#ifdef NDEBUG
+#define INTRUSIVE_SAFE_MODE 0
+#else
+#define INTRUSIVE_SAFE_MODE 1
+#endif
+#endif
+
+#if INTRUSIVE_SAFE_MODE
+#define SAFE_CHECK(condition, msg) do { if (!(condition)) throw std::runtime_error(msg); } while (0)
+#else
+#define SAFE_CHECK(condition, msg) do { } while (0)
+#endif
+
+// Hook to embed for singly linked lists
+struct SinglyHook
+{
+    SinglyHook* next = NULL;
+#if INTRUSIVE_SAFE_MODE
+    const void* list = NULL; // List the hook is linked in
+#endif
+};
+
+// Hook to embed for doubly and circular doubly linked lists
+struct DoublyHook
+{
+    DoublyHook* prev = NULL;
+    DoublyHook* next = NULL;
+#if INTRUSIVE_SAFE_MODE
+    const void* list = NULL; // List the hook is linked in
+#endif
+};
+
+// Returns the object owning the given hook
+template<class T, class H, H T::*Hook>
+T* owner_of(H* hook)
+{
+    if (hook == NULL) {
+        return NULL;
+    }
+    // Offset of the hook inside T, computed on a properly aligned dummy object
+    alignas(T) static char dummy[sizeof(T)];
+    T* object = reinterpret_cast<T*>(dummy);
+    ptrdiff_t offset = reinterpret_cast<char*>(&(object->*Hook)) - dummy;
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(hook) - offset);
+}
+
+// Record the list a hook is linked in, NULL when unlinked, in safe mode
+template<class H>
+void set_list(H& hook, const void* list)
+{
+#if INTRUSIVE_SAFE_MODE
+    hook.list = list;
+#else
+    (void)hook;
+    (void)list;
+#endif
+}
+
+/**
+ * Intrusive singly linked list implementation
+ */
+template<class T, SinglyHook T::*Hook>
+class IntrusiveList
+{
+    // Head of the list
+    SinglyHook* head;
+
+public:
+    // Constructor
+    IntrusiveList() : head(NULL) {}
+
+    // Insert an object in front of the list
+    void insert_front(T& object);
+
+    // Insert an object after the given object
+    void insert_after(T& prev, T& object);
+
+    // Unlink the front object
+    // Returns the object unlinked if available, NULL otherwise.
+    T* delete_front();
+
+    // Unlink the object after the given object
+    // Returns the object unlinked if available, NULL otherwise.
+    T* delete_after(T& prev);
+
+    // Search and unlink the given object
+    // Returns true on success, false otherwise.
+    bool remove(T& object);
+
+    // Search the first object matching the predicate
+    // Returns the matching object if found, NULL otherwise.
+    template<class Predicate>
+    T* search(Predicate matches);
+
+    // Call the function for every object from start to end
+    template<class Function>
+    void for_each(Function f);
+
+private:
+    static T* owner(SinglyHook* hook) { return owner_of<T, SinglyHook, Hook>(hook); }
+};
+
+template<class T, SinglyHook T::*Hook>
+void IntrusiveList<T, Hook>::insert_front(T& object)
+{
+    // Step 1. Take the hook of the object
+    SinglyHook& hook = object.*Hook;
+    SAFE_CHECK(hook.list == NULL, "object already linked");
+    set_list(hook, this);
+
+    // Step 2. Link before the head node
+    hook.next = head;
+
+    // Step 3. Change the head to point the new object
+    head = &hook;
+}
+
+template<class T, SinglyHook T::*Hook>
+void IntrusiveList<T, Hook>::insert_after(T& prev, T& object)
+{
+    SinglyHook& hook = object.*Hook;
+    SinglyHook& prev_hook = prev.*Hook;
+    SAFE_CHECK(hook.list == NULL, "object already linked");
+    SAFE_CHECK(prev_hook.list == this, "previous object not linked in this list");
+    set_list(hook, this);
+
+    // Link the object after the given object
+    hook.next = prev_hook.next;
+    prev_hook.next = &hook;
+}
+
+template<class T, SinglyHook T::*Hook>
+T* IntrusiveList<T, Hook>::delete_front()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (head == NULL) {
+        return NULL;
+    }
+
+    // Step 2. Move the head to next object
+    SinglyHook* target = head;
+    head = head->next;
+
+    // Step 3. Reset the hook of the unlinked object
+    target->next = NULL;
+    set_list(*target, NULL);
+    return owner(target);
+}
+
+template<class T, SinglyHook T::*Hook>
+T* IntrusiveList<T, Hook>::delete_after(T& prev)
+{
+    // Step 1. Check if there is an object after prev and return if not.
+    SinglyHook& prev_hook = prev.*Hook;
+    SAFE_CHECK(prev_hook.list == this, "previous object not linked in this list");
+    SinglyHook* target = prev_hook.next;
+    if (target == NULL) {
+        return NULL;
+    }
+
+    // Step 2. Disconnect the target by linking prev to its next
+    prev_hook.next = target->next;
+
+    // Step 3. Reset the hook of the unlinked object
+    target->next = NULL;
+    set_list(*target, NULL);
+    return owner(target);
+}
+
+template<class T, SinglyHook T::*Hook>
+bool IntrusiveList<T, Hook>::remove(T& object)
+{
+    // Step 1. Walk the links until the one pointing to the object
+    SinglyHook* target = &(object.*Hook);
+    for (SinglyHook** link = &head; *link != NULL; link = &(*link)->next) {
+        if (*link == target) {
+            // Step 2. Bypass the object and reset its hook
+            *link = target->next;
+            target->next = NULL;
+            set_list(*target, NULL);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class T, SinglyHook T::*Hook>
+template<class Predicate>
+T* IntrusiveList<T, Hook>::search(Predicate matches)
+{
+    for (SinglyHook* hook = head; hook != NULL; hook = hook->next) {
+        if (matches(*owner(hook))) {
+            return owner(hook);
+        }
+    }
+    return NULL;
+}
+
+template<class T, SinglyHook T::*Hook>
+template<class Function>
+void IntrusiveList<T, Hook>::for_each(Function f)
+{
+    for (SinglyHook* hook = head; hook != NULL; hook = hook->next) {
+        f(*owner(hook));
+    }
+}
+
+/**
+ * Intrusive doubly linked list implementation
+ */
+template<class T, DoublyHook T::*Hook>
+class IntrusiveDoublyList
+{
+    // Head and tail of the list
+    DoublyHook* head;
+    DoublyHook* tail;
+
+public:
+    // Constructor
+    IntrusiveDoublyList() : head(NULL), tail(NULL) {}
+
+    // Insert an object in front of the list
+    void insert_front(T& object);
+
+    // Insert an object at the end of the list
+    void insert_back(T& object);
+
+    // Insert an object after the given object
+    void insert_after(T& prev, T& object);
+
+    // Unlink the given object in O(1)
+    void unlink(T& object);
+
+    // Unlink the front object
+    // Returns the object unlinked if available, NULL otherwise.
+    T* delete_front();
+
+    // Unlink the last object
+    // Returns the object unlinked if available, NULL otherwise.
+    T* delete_back();
+
+    // Search the first object matching the predicate
+    // Returns the matching object if found, NULL otherwise.
+    template<class Predicate>
+    T* search(Predicate matches);
+
+    // Call the function for every object from start to end
+    template<class Function>
+    void for_each(Function f);
+
+private:
+    static T* owner(DoublyHook* hook) { return owner_of<T, DoublyHook, Hook>(hook); }
+};
+
+template<class T, DoublyHook T::*Hook>
+void IntrusiveDoublyList<T, Hook>::insert_front(T& object)
+{
+    DoublyHook& hook = object.*Hook;
+    SAFE_CHECK(hook.list == NULL, "object already linked");
+    set_list(hook, this);
+
+    // Link the object before the head
+    hook.prev = NULL;
+    hook.next = head;
+    if (head != NULL) {
+        head->prev = &hook;
+    } else {
+        tail = &hook;
+    }
+    head = &hook;
+}
+
+template<class T, DoublyHook T::*Hook>
+void IntrusiveDoublyList<T, Hook>::insert_back(T& object)
+{
+    DoublyHook& hook = object.*Hook;
+    SAFE_CHECK(hook.list == NULL, "object already linked");
+    set_list(hook, this);
+
+    // Link the object after the tail
+    hook.next = NULL;
+    hook.prev = tail;
+    if (tail != NULL) {
+        tail->next = &hook;
+    } else {
+        head = &hook;
+    }
+    tail = &hook;
+}
+
+template<class T, DoublyHook T::*Hook>
+void IntrusiveDoublyList<T, Hook>::insert_after(T& prev, T& object)
+{
+    DoublyHook& hook = object.*Hook;
+    DoublyHook& prev_hook = prev.*Hook;
+    SAFE_CHECK(hook.list == NULL, "object already linked");
+    SAFE_CHECK(prev_hook.list == this, "previous object not linked in this list");
+    set_list(hook, this);
+
+    // Link the object after the given object
+    hook.prev = &prev_hook;
+    hook.next = prev_hook.next;
+    prev_hook.next = &hook;
+    if (hook.next != NULL) {
+        hook.next->prev = &hook;
+    } else {
+        tail = &hook;
+    }
+}
+
+template<class T, DoublyHook T::*Hook>
+void IntrusiveDoublyList<T, Hook>::unlink(T& object)
+{
+    DoublyHook& hook = object.*Hook;
+    SAFE_CHECK(hook.list == this, "object not linked in this list");
+
+    // Step 1. Connect the previous and next objects directly
+    if (hook.prev != NULL) {
+        hook.prev->next = hook.next;
+    } else {
+        head = hook.next;
+    }
+    if (hook.next != NULL) {
+        hook.next->prev = hook.prev;
+    } else {
+        tail = hook.prev;
+    }
+
+    // Step 2. Reset the hook
+    hook.prev = NULL;
+    hook.next = NULL;
+    set_list(hook, NULL);
+}
+
+template<class T, DoublyHook T::*Hook>
+T* IntrusiveDoublyList<T, Hook>::delete_front()
+{
+    if (head == NULL) {
+        return NULL;
+    }
+    T* object = owner(head);
+    unlink(*object);
+    return object;
+}
+
+template<class T, DoublyHook T::*Hook>
+T* IntrusiveDoublyList<T, Hook>::delete_back()
+{
+    if (tail == NULL) {
+        return NULL;
+    }
+    T* object = owner(tail);
+    unlink(*object);
+    return object;
+}
+
+template<class T, DoublyHook T::*Hook>
+template<class Predicate>
+T* IntrusiveDoublyList<T, Hook>::search(Predicate matches)
+{
+    for (DoublyHook* hook = head; hook != NULL; hook = hook->next) {
+        if (matches(*owner(hook))) {
+            return owner(hook);
+        }
+    }
+    return NULL;
+}
+
+template<class T, DoublyHook T::*Hook>
+template<class Function>
+void IntrusiveDoublyList<T, Hook>::for_each(Function f)
+{
+    for (DoublyHook* hook = head; hook != NULL; hook = hook->next) {
+        f(*owner(hook));
+    }
+}
+
+/**
+ * Intrusive circular doubly linked list implementation
+ */
+template<class T, DoublyHook T::*Hook>
+class IntrusiveCircularList
+{
+    // The first object of the list
+    DoublyHook* head;
+
+public:
+    // Constructor
+    IntrusiveCircularList() : head(NULL) {}
+
+    // Insert an object in front of the list
+    void insert_front(T& object);
+
+    // Insert an object at the end of the list
+    void insert_back(T& object);
+
+    // Unlink the given object in O(1)
+    void unlink(T& object);
+
+    // Returns the first object, NULL if the list is empty
+    T* front() { return owner(head); }
+
+    // Call the function for every object from start to end
+    // The function may unlink the object it is called for, but no other.
+    template<class Function>
+    void for_each(Function f);
+
+private:
+    static T* owner(DoublyHook* hook) { return owner_of<T, DoublyHook, Hook>(hook); }
+};
+
+template<class T, DoublyHook T::*Hook>
+void IntrusiveCircularList<T, Hook>::insert_back(T& object)
+{
+    DoublyHook& hook = object.*Hook;
+    SAFE_CHECK(hook.list == NULL, "object already linked");
+    set_list(hook, this);
+
+    // Step 1. Check if the list is empty. If true, make the object
+    // as head and point itself to form the one object circle.
+    if (head == NULL) {
+        hook.prev = &hook;
+        hook.next = &hook;
+        head = &hook;
+        return;
+    }
+
+    // Step 2. Link the object between the last object and the head
+    hook.prev = head->prev;
+    hook.prev->next = &hook;
+    hook.next = head;
+    head->prev = &hook;
+}
+
+template<class T, DoublyHook T::*Hook>
+void IntrusiveCircularList<T, Hook>::insert_front(T& object)
+{
+    // Insert at the end of the circle and make it the head
+    insert_back(object);
+    head = &(object.*Hook);
+}
+
+template<class T, DoublyHook T::*Hook>
+void IntrusiveCircularList<T, Hook>::unlink(T& object)
+{
+    DoublyHook& hook = object.*Hook;
+    SAFE_CHECK(hook.list == this, "object not linked in this list");
+
+    // Step 1. Check if the object is alone in the circle. If true, empty the list.
+    if (hook.next == &hook) {
+        head = NULL;
+    } else {
+        // Step 2. Otherwise connect its previous and next objects directly
+        hook.prev->next = hook.next;
+        hook.next->prev = hook.prev;
+        if (head == &hook) {
+            head = hook.next;
+        }
+    }
+
+    // Step 3. Reset the hook
+    hook.prev = NULL;
+    hook.next = NULL;
+    set_list(hook, NULL);
+}
+
+template<class T, DoublyHook T::*Hook>
+template<class Function>
+void IntrusiveCircularList<T, Hook>::for_each(Function f)
+{
+    if (head == NULL) {
+        return;
+    }
+    // Stop after the object which was last when the walk started, since
+    // the head moves when the function unlinks the head object
+    DoublyHook* last = head->prev;
+    DoublyHook* hook = head;
+    for (;;) {
+        // Read next first, the function may unlink the object
+        DoublyHook* next = hook->next;
+        bool done = (hook == last);
+        f(*owner(hook));
+        if (done) {
+            return;
+        }
+        hook = next;
+    }
+}
+
+// An object which is a member of two lists at the same time
+struct Task
+{
+    int id;
+    int priority;
+    SinglyHook all;     // Member of the list of all tasks
+    DoublyHook pending; // Member of the pending or the running list
+};
+
+// Print the ids of the objects in a list
+template<class List>
+void print(List& list, const std::string& msg)
+{
+    cout << msg << endl;
+    cout << "HEAD ==> ";
+    list.for_each([](Task& task) { cout << task.id << " ==> "; });
+    cout << "NULL" << endl << endl;
+}
+
+// Node of a regular allocating doubly linked list, used for comparison
+struct ListNode
+{
+    Task* element;
+    ListNode* prev;
+    ListNode* next;
+};
+
+// Link 1M existing objects and unlink them in another order,
+// once with the intrusive list and once allocating a node per element
+void benchmark(int count)
+{
+    std::vector<Task> tasks(count);
+    for (int i=0; i < count; i++) {
+        tasks[i].id = i;
+    }
+
+    // Intrusive: link every object, then unlink every other one, then the rest
+    auto start = chrono::steady_clock::now();
+    IntrusiveDoublyList<Task, &Task::pending> intrusive;
+    for (int i=0; i < count; i++) {
+        intrusive.insert_back(tasks[i]);
+    }
+    for (int i=0; i < count; i += 2) {
+        intrusive.unlink(tasks[i]);
+    }
+    while (intrusive.delete_front() != NULL) {
+    }
+    double intrusive_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Allocating: a node per element, and a side table to find the node of an object
+    start = chrono::steady_clock::now();
+    std::vector<ListNode*> node_of(count);
+    ListNode* head = NULL;
+    ListNode* tail = NULL;
+    for (int i=0; i < count; i++) {
+        ListNode* node = new ListNode();
+        node->element = &tasks[i];
+        node->prev = tail;
+        node->next = NULL;
+        if (tail != NULL) {
+            tail->next = node;
+        } else {
+            head = node;
+        }
+        tail = node;
+        node_of[i] = node;
+    }
+    for (int i=0; i < count; i += 2) {
+        ListNode* node = node_of[i];
+        if (node->prev != NULL) node->prev->next = node->next; else head = node->next;
+        if (node->next != NULL) node->next->prev = node->prev; else tail = node->prev;
+        delete node;
+    }
+    while (head != NULL) {
+        ListNode* target = head;
+        head = head->next;
+        delete target;
+    }
+    double allocating_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "Benchmark linking and unlinking " << count << " objects" << endl;
+    cout << "  intrusive " << intrusive_ms << " ms, allocating " << allocating_ms << " ms" << endl;
+}
+
+int main()
+{
+    Task tasks[5];
+    for (int i=0; i < 5; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].priority = (i * 7) % 5;
+    }
+
+    // Singly list of all tasks
+    IntrusiveList<Task, &Task::all> all;
+    for (int i=4; i >= 0; i--) {
+        all.insert_front(tasks[i]);
+    }
+    print(all, "all tasks after insert_front 5, 4, 3, 2, 1");
+
+    Task* task = all.search([](Task& t) { return t.priority == 4; });
+    cout << "search(priority == 4) matches task " << task->id << endl << endl;
+
+    all.delete_after(tasks[0]);
+    print(all, "all tasks after delete_after(task 1)");
+
+    // Doubly list of pending tasks, the same objects are in both lists
+    IntrusiveDoublyList<Task, &Task::pending> pending;
+    pending.insert_back(tasks[0]);
+    pending.insert_back(tasks[2]);
+    pending.insert_back(tasks[4]);
+    print(pending, "pending tasks after insert_back 1, 3, 5");
+
+    pending.unlink(tasks[2]);
+    print(pending, "pending tasks after unlink(task 3)");
+
+#if INTRUSIVE_SAFE_MODE
+    // A task hook can only be in one list at a time
+    try {
+        pending.insert_back(tasks[0]);
+    } catch (const std::exception& e) {
+        cout << "insert_back(task 1) again: exception received: " << e.what() << endl << endl;
+    }
+#endif
+
+    // Circular doubly list, a round robin of running tasks
+    IntrusiveCircularList<Task, &Task::pending> running;
+    running.insert_back(tasks[1]);
+    running.insert_back(tasks[2]);
+    running.insert_front(tasks[3]);
+    print(running, "running tasks after insert_back 2, 3 and insert_front 4");
+
+    running.unlink(tasks[1]);
+    print(running, "running tasks after unlink(task 2)");
+
+#if INTRUSIVE_SAFE_MODE
+    // Task 4 is running, so it cannot be unlinked through the pending list
+    try {
+        pending.unlink(tasks[3]);
+    } catch (const std::exception& e) {
+        cout << "pending.unlink(task 4): exception received: " << e.what() << endl << endl;
+    }
+#endif
+
+    // Unlink every running task while walking the circle
+    int visited = 0;
+    running.for_each([&](Task& t) { running.unlink(t); visited++; });
+    cout << "for_each unlinking every running task visited " << visited << " tasks" << endl;
+    print(running, "running tasks after unlinking all");
+
+    benchmark(1000000);
+}
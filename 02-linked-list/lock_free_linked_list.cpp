@@ -0,0 +1,642 @@
+/**
+ * C++ example to demonstrate a lock-free sorted Singly Linked List
+ *
+ * The Harris-Michael list keeps the elements sorted and lets many threads
+ * insert, remove and search at the same time without any lock:
+ *   - A node is deleted in two steps. First the lowest bit of its next
+ *     pointer is set (marked), which logically removes it and stops
+ *     anyone from linking after it. Then it is unlinked with a CAS on the
+ *     previous node, by the remover or by any thread passing by.
+ *   - Hazard pointers (Michael) protect the nodes a thread is looking at.
+ *     An unlinked node is freed only when no thread publishes it.
+ *
+ * Compile with: g++ -std=c++17 -O2 -pthread lock_free_linked_list.cpp
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// Maximum number of threads using one list
+#define MAX_THREADS 128
+
+// Number of hazard pointers per thread
+#define HAZARDS 3
+
+// Linked list node representation
+struct Node
+{
+    int element;
+    std::atomic<uintptr_t> next; // Next node with the deletion mark in the lowest bit
+};
+
+// Helpers for marked pointers
+static inline Node* pointer_of(uintptr_t link) { return reinterpret_cast<Node*>(link & ~(uintptr_t)1); }
+static inline bool is_marked(uintptr_t link) { return (link & 1) != 0; }
+static inline uintptr_t link_of(Node* node) { return reinterpret_cast<uintptr_t>(node); }
+
+/**
+ * Hazard pointer domain
+ */
+class HazardPointers
+{
+    // Per thread state, padded to its own cache line
+    struct alignas(64) Record
+    {
+        std::atomic<std::thread::id> owner;
+        std::atomic<Node*> hazard[HAZARDS];
+        std::vector<Node*> retired;
+    };
+
+    // Thread records
+    Record records[MAX_THREADS];
+
+    // Retired nodes left by threads which exited while the nodes were still hazardous
+    std::mutex orphan_lock;
+    std::vector<Node*> orphans;
+
+    // Unique id, used to find the cached record of the calling thread
+    unsigned long id;
+
+    /**
+     * Records claimed by the calling thread, handed back when it exits
+     */
+    struct Claim
+    {
+        unsigned long id;
+        HazardPointers* domain;
+        Record* record;
+    };
+
+    struct ThreadRecords
+    {
+        std::vector<Claim> claimed;
+        ~ThreadRecords();
+    };
+
+public:
+    // Constructor
+    HazardPointers();
+
+    // Destructor frees every retired node
+    ~HazardPointers();
+
+    // Returns the hazard pointer slots of the calling thread
+    // A node is published by storing it into a slot.
+    std::atomic<Node*>* slots();
+
+    // Clear all the slots of the calling thread
+    void clear();
+
+    // Free the node once no hazard pointer refers to it
+    void retire(Node* node);
+
+private:
+    // Returns the record of the calling thread
+    Record* record();
+
+    // Free the retired nodes which are not protected, adopting the orphans first
+    void scan(Record* r);
+
+    // Ids of the live domains, guarded by registry_lock()
+    // A domain never leaves the registry while a thread hands back its record.
+    static std::set<unsigned long>& registry()
+    {
+        static std::set<unsigned long> ids;
+        return ids;
+    }
+
+    static std::mutex& registry_lock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+};
+
+HazardPointers::HazardPointers()
+{
+    static std::atomic<unsigned long> counter(0);
+    id = ++counter;
+    {
+        std::lock_guard<std::mutex> guard(registry_lock());
+        registry().insert(id);
+    }
+    for (int i=0; i < MAX_THREADS; i++) {
+        records[i].owner.store(std::thread::id());
+        for (int h=0; h < HAZARDS; h++) {
+            records[i].hazard[h].store(NULL);
+        }
+    }
+}
+
+HazardPointers::~HazardPointers()
+{
+    {
+        std::lock_guard<std::mutex> guard(registry_lock());
+        registry().erase(id);
+    }
+    for (int i=0; i < MAX_THREADS; i++) {
+        for (size_t n=0; n < records[i].retired.size(); n++) {
+            delete records[i].retired[n];
+        }
+    }
+    for (size_t n=0; n < orphans.size(); n++) {
+        delete orphans[n];
+    }
+}
+
+HazardPointers::Record* HazardPointers::record()
+{
+    // Step 1. Check the record cached by this thread
+    static thread_local unsigned long cached_id = 0;
+    static thread_local Record* cached = NULL;
+    if (cached_id == id) {
+        return cached;
+    }
+
+    // Step 2. Otherwise find the record this thread claimed before
+    static thread_local ThreadRecords thread;
+    Record* found = NULL;
+    for (size_t i=0; i < thread.claimed.size() && found == NULL; i++) {
+        if (thread.claimed[i].id == id) {
+            found = thread.claimed[i].record;
+        }
+    }
+
+    // Step 3. Or claim a free one, forgetting the records of destroyed domains first
+    if (found == NULL) {
+        std::lock_guard<std::mutex> guard(registry_lock());
+        size_t kept = 0;
+        for (size_t i=0; i < thread.claimed.size(); i++) {
+            if (registry().count(thread.claimed[i].id) != 0) {
+                thread.claimed[kept++] = thread.claimed[i];
+            }
+        }
+        thread.claimed.resize(kept);
+    }
+    std::thread::id self = std::this_thread::get_id();
+    for (int i=0; i < MAX_THREADS && found == NULL; i++) {
+        std::thread::id none;
+        if (records[i].owner.compare_exchange_strong(none, self)) {
+            found = &records[i];
+            Claim claim = { id, this, found };
+            thread.claimed.push_back(claim);
+        }
+    }
+    if (found == NULL) {
+        throw std::runtime_error("too many threads");
+    }
+
+    cached_id = id;
+    cached = found;
+    return found;
+}
+
+HazardPointers::ThreadRecords::~ThreadRecords()
+{
+    // Hand back the records of the domains still alive
+    std::lock_guard<std::mutex> guard(registry_lock());
+    for (size_t i=0; i < claimed.size(); i++) {
+        if (registry().count(claimed[i].id) == 0) {
+            continue;
+        }
+        HazardPointers* domain = claimed[i].domain;
+        Record* r = claimed[i].record;
+
+        // Step 1. Clear the hazards, free what is safe and leave the rest to the domain
+        for (int h=0; h < HAZARDS; h++) {
+            r->hazard[h].store(NULL);
+        }
+        domain->scan(r);
+        {
+            std::lock_guard<std::mutex> orphan_guard(domain->orphan_lock);
+            domain->orphans.insert(domain->orphans.end(), r->retired.begin(), r->retired.end());
+        }
+        r->retired.clear();
+
+        // Step 2. Release the record
+        r->owner.store(std::thread::id());
+    }
+}
+
+std::atomic<Node*>* HazardPointers::slots()
+{
+    return record()->hazard;
+}
+
+void HazardPointers::clear()
+{
+    Record* r = record();
+    for (int h=0; h < HAZARDS; h++) {
+        r->hazard[h].store(NULL, std::memory_order_release);
+    }
+}
+
+void HazardPointers::retire(Node* node)
+{
+    Record* r = record();
+    r->retired.push_back(node);
+
+    // Scan once the retired list is large compared to the number of hazards,
+    // so that every scan frees a good part of it
+    if (r->retired.size() >= 2 * HAZARDS * 8) {
+        scan(r);
+    }
+}
+
+void HazardPointers::scan(Record* r)
+{
+    // Step 1. Adopt the orphans of exited threads, and collect all the
+    // published hazard pointers
+    {
+        std::lock_guard<std::mutex> guard(orphan_lock);
+        r->retired.insert(r->retired.end(), orphans.begin(), orphans.end());
+        orphans.clear();
+    }
+    std::vector<Node*> protected_nodes;
+    for (int i=0; i < MAX_THREADS; i++) {
+        for (int h=0; h < HAZARDS; h++) {
+            Node* node = records[i].hazard[h].load();
+            if (node != NULL) {
+                protected_nodes.push_back(node);
+            }
+        }
+    }
+
+    // Step 2. Free the retired nodes not found in the hazard pointers,
+    // and keep the others for the next scan
+    std::vector<Node*> keep;
+    for (size_t n=0; n < r->retired.size(); n++) {
+        bool hazardous = false;
+        for (size_t p=0; p < protected_nodes.size() && !hazardous; p++) {
+            hazardous = (protected_nodes[p] == r->retired[n]);
+        }
+        if (hazardous) {
+            keep.push_back(r->retired[n]);
+        } else {
+            delete r->retired[n];
+        }
+    }
+    r->retired.swap(keep);
+}
+
+/**
+ * Lock-free sorted linked list implementation
+ */
+class LockFreeList
+{
+    // Head of the list
+    std::atomic<uintptr_t> head;
+
+    // Protects the nodes in use
+    HazardPointers hazards;
+
+public:
+    // Constructor
+    LockFreeList() : head(0) {}
+
+    // Destructor
+    ~LockFreeList();
+
+    // Insert an element in its sorted position
+    // Returns true if inserted, false if already present.
+    bool insert(int element);
+
+    // Delete an element
+    // Returns true if removed, false if not present.
+    bool remove(int element);
+
+    // Check if the element is present
+    bool search(int element);
+
+    // Traverse the elements
+    // Not safe to call concurrently with writers.
+    void traverse(const std::string& msg);
+
+private:
+    // Find the first node not less than the element, unlinking the marked
+    // nodes on the way. On return prev is the link pointing to curr, and
+    // both the node owning prev and curr are protected.
+    // Returns true if curr holds the element.
+    bool find(int element, std::atomic<uintptr_t>*& prev, Node*& curr, Node*& next);
+};
+
+LockFreeList::~LockFreeList()
+{
+    // Release the nodes from front to end
+    Node* node = pointer_of(head.load());
+    while (node != NULL) {
+        Node* target = node;
+        node = pointer_of(node->next.load());
+        delete target;
+    }
+}
+
+bool LockFreeList::find(int element, std::atomic<uintptr_t>*& prev, Node*& curr, Node*& next)
+{
+    // Hazard pointers of this thread. The roles of the three slots rotate
+    // while walking, so that every node is published only once. The stores
+    // are sequentially consistent to be visible before the validating re-read.
+    std::atomic<Node*>* hp = hazards.slots();
+
+retry:
+    int hp_next = 0, hp_curr = 1, hp_prev = 2;
+
+    // Step 1. Start at the head, protecting the first node
+    prev = &head;
+    curr = pointer_of(prev->load());
+    hp[hp_curr].store(curr);
+    if (prev->load() != link_of(curr)) {
+        goto retry;
+    }
+
+    while (curr != NULL) {
+        // Step 2. Protect the next node and validate curr still points to it
+        uintptr_t next_link = curr->next.load();
+        next = pointer_of(next_link);
+        hp[hp_next].store(next);
+        if (curr->next.load() != next_link) {
+            goto retry;
+        }
+
+        // Step 3. Validate prev still points to curr, otherwise curr may be gone
+        int curr_element = curr->element;
+        if (prev->load() != link_of(curr)) {
+            goto retry;
+        }
+
+        if (!is_marked(next_link)) {
+            // Step 4. curr is alive. Stop at the first element not less than the given one.
+            if (curr_element >= element) {
+                return curr_element == element;
+            }
+            // Move on: the node owning prev becomes curr
+            prev = &curr->next;
+            std::swap(hp_prev, hp_curr);
+        } else {
+            // Step 5. curr is marked. Unlink it from prev and retire it.
+            uintptr_t expected = link_of(curr);
+            if (!prev->compare_exchange_strong(expected, link_of(next))) {
+                goto retry;
+            }
+            hazards.retire(curr);
+        }
+
+        // Step 6. Advance, next becomes curr
+        curr = next;
+        std::swap(hp_curr, hp_next);
+    }
+    return false;
+}
+
+bool LockFreeList::insert(int element)
+{
+    Node* new_node = new Node();
+    new_node->element = element;
+    std::atomic<uintptr_t>* prev;
+    Node* curr;
+    Node* next;
+
+    while (true) {
+        // Step 1. Find the position. Return if the element is already present.
+        if (find(element, prev, curr, next)) {
+            delete new_node;
+            hazards.clear();
+            return false;
+        }
+
+        // Step 2. Link the new node before curr. If prev changed meanwhile,
+        // find the position again.
+        new_node->next.store(link_of(curr), std::memory_order_relaxed);
+        uintptr_t expected = link_of(curr);
+        if (prev->compare_exchange_strong(expected, link_of(new_node))) {
+            hazards.clear();
+            return true;
+        }
+    }
+}
+
+bool LockFreeList::remove(int element)
+{
+    std::atomic<uintptr_t>* prev;
+    Node* curr;
+    Node* next;
+
+    while (true) {
+        // Step 1. Find the node. Return if the element is not present.
+        if (!find(element, prev, curr, next)) {
+            hazards.clear();
+            return false;
+        }
+
+        // Step 2. Mark the node. If its next pointer changed, try again.
+        uintptr_t next_link = link_of(next);
+        if (!curr->next.compare_exchange_strong(next_link, next_link | 1)) {
+            continue;
+        }
+
+        // Step 3. Unlink the node. If prev changed, let find() unlink it.
+        uintptr_t expected = link_of(curr);
+        if (prev->compare_exchange_strong(expected, link_of(next))) {
+            hazards.retire(curr);
+        } else {
+            find(element, prev, curr, next);
+        }
+        hazards.clear();
+        return true;
+    }
+}
+
+bool LockFreeList::search(int element)
+{
+    std::atomic<uintptr_t>* prev;
+    Node* curr;
+    Node* next;
+    bool found = find(element, prev, curr, next);
+    hazards.clear();
+    return found;
+}
+
+void LockFreeList::traverse(const std::string& msg)
+{
+    cout << msg << endl;
+    cout << "HEAD ==> ";
+    for (Node* node = pointer_of(head.load()); node != NULL; node = pointer_of(node->next.load())) {
+        if (!is_marked(node->next.load())) {
+            cout << node->element << " ==> ";
+        }
+    }
+    cout << "NULL" << endl << endl;
+}
+
+// Plain sorted singly linked list guarded by one mutex, used for comparison
+class MutexList
+{
+    struct PlainNode
+    {
+        int element;
+        PlainNode* next;
+    };
+
+    PlainNode* head;
+    std::mutex lock;
+
+public:
+    MutexList() : head(NULL) {}
+
+    ~MutexList()
+    {
+        while (head != NULL) {
+            PlainNode* target = head;
+            head = head->next;
+            delete target;
+        }
+    }
+
+    bool insert(int element)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        PlainNode** prev = &head;
+        while (*prev != NULL && (*prev)->element < element) {
+            prev = &(*prev)->next;
+        }
+        if (*prev != NULL && (*prev)->element == element) {
+            return false;
+        }
+        PlainNode* new_node = new PlainNode();
+        new_node->element = element;
+        new_node->next = *prev;
+        *prev = new_node;
+        return true;
+    }
+
+    bool remove(int element)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        PlainNode** prev = &head;
+        while (*prev != NULL && (*prev)->element < element) {
+            prev = &(*prev)->next;
+        }
+        if (*prev == NULL || (*prev)->element != element) {
+            return false;
+        }
+        PlainNode* target = *prev;
+        *prev = target->next;
+        delete target;
+        return true;
+    }
+
+    bool search(int element)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        PlainNode* node = head;
+        while (node != NULL && node->element < element) {
+            node = node->next;
+        }
+        return node != NULL && node->element == element;
+    }
+};
+
+// Run a mixed workload of 10% insert, 10% remove and 80% search
+// Returns the throughput in operations per second
+template<class ListType>
+long long run(int threads, int ops, int key_range)
+{
+    ListType list;
+    for (int k=0; k < key_range; k += 2) {
+        list.insert(k);
+    }
+
+    auto worker = [&](int t) {
+        unsigned int x = 88172645u + t * 7919u;
+        for (int i=0; i < ops / threads; i++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            int key = x % key_range;
+            int op = (x >> 20) % 10;
+            if (op == 0) {
+                list.insert(key);
+            } else if (op == 1) {
+                list.remove(key);
+            } else {
+                list.search(key);
+            }
+        }
+    };
+
+    auto start = chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t=0; t < threads; t++) {
+        pool.push_back(std::thread(worker, t));
+    }
+    for (size_t t=0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return (long long)(ops / ms * 1000);
+}
+
+int main()
+{
+    // Create a lock-free list
+    LockFreeList list;
+
+    // Insert elements, they are kept sorted
+    list.insert(30);
+    list.insert(10);
+    list.insert(20);
+    cout << "insert(20) again returns " << list.insert(20) << endl;
+    list.traverse("insert(30), insert(10), insert(20)");
+
+    // Search elements
+    cout << "search(20) returns " << list.search(20) << endl;
+    cout << "search(25) returns " << list.search(25) << endl << endl;
+
+    // Delete elements
+    list.remove(20);
+    cout << "remove(20) again returns " << list.remove(20) << endl;
+    list.traverse("remove(20)");
+
+    // More threads than records, in waves of MAX_THREADS / 4. Each exiting
+    // thread hands its record back; no thread is joined before the end, so
+    // no thread id is reused.
+    std::vector<std::thread> waves;
+    std::atomic<int> done(0);
+    for (int t=0; t < 4 * MAX_THREADS; t++) {
+        waves.emplace_back([&list, &done, t]() { list.insert(1000 + t); list.remove(1000 + t); done++; });
+        while (t % (MAX_THREADS / 4) == MAX_THREADS / 4 - 1 && done.load() <= t) {
+            std::this_thread::yield();
+        }
+    }
+    for (size_t i=0; i < waves.size(); i++) {
+        waves[i].join();
+    }
+    cout << 4 * MAX_THREADS << " threads done, search(1000) returns " << list.search(1000) << endl << endl;
+
+    // Concurrent workload
+    const int ranges[] = { 16, 256, 2048 };
+    cout << " KEYS | THREADS | LOCK-FREE OPS/SEC | MUTEX OPS/SEC" << endl;
+    cout << "------+---------+-------------------+--------------" << endl;
+    for (int range : ranges) {
+        for (int threads=1; threads <= 16; threads *= 2) {
+            long long lock_free = run<LockFreeList>(threads, 200000, range);
+            long long mutex = run<MutexList>(threads, 200000, range);
+            cout.width(5);
+            cout << range << " | ";
+            cout.width(7);
+            cout << threads << " | ";
+            cout.width(17);
+            cout << lock_free << " | ";
+            cout.width(13);
+            cout << mutex << endl;
+        }
+    }
+}
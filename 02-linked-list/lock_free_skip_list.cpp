@@ -0,0 +1,659 @@
+/**
+ * C++ example to demonstrate a lock-free concurrent Skip List
+ *
+ * The skip list of skip_list.cpp made safe for many threads without locks,
+ * following Fraser and Herlihy-Shavit:
+ *   - The lowest bit of a next pointer marks the node as deleted at that
+ *     level, so no thread can link a new node after it.
+ *   - remove() marks the levels top-down. Marking level 0 is the moment
+ *     the element leaves the set. Marked nodes are unlinked by the next
+ *     find() walking over them.
+ *   - contains() never writes and never retries, so it is wait-free.
+ *   - Removed nodes are freed with epoch-based reclamation: a node retired
+ *     in epoch e is freed once every active thread has moved to e+2.
+ *     A thread's epoch record is handed back when the thread exits.
+ *
+ * The head and tail sentinels are told apart by identity, not by their
+ * elements, so every int value can be stored, INT_MIN and INT_MAX included.
+ *
+ * Compile with: g++ -std=c++17 -O2 -pthread lock_free_skip_list.cpp
+ */
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Maximum number of levels
+#define MAX_LEVEL 24
+
+// Maximum number of threads using one list
+#define MAX_THREADS 128
+
+// Skip list node representation
+struct Node
+{
+    int element;
+    int level;                      // Number of links in next[]
+    std::atomic<int> owners;        // Inserter and remover still using the node
+    std::atomic<uintptr_t> next[1]; // Links with the deletion mark in the lowest bit
+};
+
+// Helpers for marked pointers
+static inline Node* pointer_of(uintptr_t link) { return reinterpret_cast<Node*>(link & ~(uintptr_t)1); }
+static inline bool is_marked(uintptr_t link) { return (link & 1) != 0; }
+static inline uintptr_t link_of(Node* node, bool marked = false) { return reinterpret_cast<uintptr_t>(node) | (marked ? 1 : 0); }
+
+/**
+ * Epoch-based memory reclamation
+ */
+class EpochReclaimer
+{
+    // Per thread state, padded to its own cache line
+    struct alignas(64) Record
+    {
+        std::atomic<std::thread::id> owner;
+        std::atomic<unsigned> epoch;
+        std::atomic<bool> active;
+        std::vector<Node*> retired[3];
+        unsigned retired_epoch[3];
+    };
+
+    // Global epoch
+    alignas(64) std::atomic<unsigned> global_epoch;
+
+    // Thread records
+    Record records[MAX_THREADS];
+
+    // Unique id, used to find the cached record of the calling thread
+    unsigned long id;
+
+    /**
+     * Records claimed by the calling thread, handed back when it exits
+     */
+    struct ThreadRecords
+    {
+        std::vector<std::pair<unsigned long, Record*> > claimed;
+        ~ThreadRecords();
+    };
+
+public:
+    // Constructor
+    EpochReclaimer();
+
+    // Destructor frees every retired node
+    ~EpochReclaimer();
+
+    // Enter a critical section; nodes seen inside stay valid until leave()
+    void enter();
+
+    // Leave the critical section
+    void leave();
+
+    // Free the node once no thread can hold a reference to it
+    void retire(Node* node);
+
+private:
+    // Returns the record of the calling thread
+    Record* record();
+
+    // Advance the global epoch if every active thread has seen it
+    void try_advance();
+
+    // Free the nodes retired in the given bucket
+    void free_bucket(Record* r, int bucket);
+
+    // Ids of the live reclaimers, guarded by registry_lock()
+    // A reclaimer never leaves the registry while a thread hands back its record.
+    static std::set<unsigned long>& registry()
+    {
+        static std::set<unsigned long> ids;
+        return ids;
+    }
+
+    static std::mutex& registry_lock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+};
+
+/**
+ * RAII guard for an epoch critical section
+ */
+struct EpochGuard
+{
+    EpochReclaimer& reclaimer;
+    EpochGuard(EpochReclaimer& r) : reclaimer(r) { reclaimer.enter(); }
+    ~EpochGuard() { reclaimer.leave(); }
+};
+
+EpochReclaimer::EpochReclaimer() : global_epoch(0)
+{
+    static std::atomic<unsigned long> counter(0);
+    id = ++counter;
+    {
+        std::lock_guard<std::mutex> guard(registry_lock());
+        registry().insert(id);
+    }
+    for (int i=0; i < MAX_THREADS; i++) {
+        records[i].owner.store(std::thread::id());
+        records[i].epoch.store(0);
+        records[i].active.store(false);
+        for (int b=0; b < 3; b++) {
+            records[i].retired_epoch[b] = 0;
+        }
+    }
+}
+
+EpochReclaimer::~EpochReclaimer()
+{
+    {
+        std::lock_guard<std::mutex> guard(registry_lock());
+        registry().erase(id);
+    }
+    for (int i=0; i < MAX_THREADS; i++) {
+        for (int b=0; b < 3; b++) {
+            free_bucket(&records[i], b);
+        }
+    }
+}
+
+EpochReclaimer::Record* EpochReclaimer::record()
+{
+    // Step 1. Check the record cached by this thread
+    static thread_local unsigned long cached_id = 0;
+    static thread_local Record* cached = NULL;
+    if (cached_id == id) {
+        return cached;
+    }
+
+    // Step 2. Otherwise find the record this thread claimed before
+    static thread_local ThreadRecords thread;
+    Record* found = NULL;
+    for (size_t i=0; i < thread.claimed.size() && found == NULL; i++) {
+        if (thread.claimed[i].first == id) {
+            found = thread.claimed[i].second;
+        }
+    }
+
+    // Step 3. Or claim a free one, forgetting the records of destroyed
+    // reclaimers first. The retired nodes left in the record by its
+    // previous owner are freed by the new owner.
+    if (found == NULL) {
+        std::lock_guard<std::mutex> guard(registry_lock());
+        size_t kept = 0;
+        for (size_t i=0; i < thread.claimed.size(); i++) {
+            if (registry().count(thread.claimed[i].first) != 0) {
+                thread.claimed[kept++] = thread.claimed[i];
+            }
+        }
+        thread.claimed.resize(kept);
+    }
+    std::thread::id self = std::this_thread::get_id();
+    for (int i=0; i < MAX_THREADS && found == NULL; i++) {
+        std::thread::id none;
+        if (records[i].owner.compare_exchange_strong(none, self)) {
+            found = &records[i];
+            thread.claimed.push_back(std::make_pair(id, found));
+        }
+    }
+    if (found == NULL) {
+        throw std::runtime_error("too many threads");
+    }
+
+    cached_id = id;
+    cached = found;
+    return found;
+}
+
+EpochReclaimer::ThreadRecords::~ThreadRecords()
+{
+    // Hand back the records of the reclaimers still alive
+    std::lock_guard<std::mutex> guard(registry_lock());
+    for (size_t i=0; i < claimed.size(); i++) {
+        if (registry().count(claimed[i].first) != 0) {
+            claimed[i].second->active.store(false);
+            claimed[i].second->owner.store(std::thread::id());
+        }
+    }
+}
+
+void EpochReclaimer::enter()
+{
+    Record* r = record();
+
+    // Step 1. Announce the current epoch. The store must be visible before
+    // any node is read, hence sequential consistency.
+    unsigned epoch = global_epoch.load();
+    r->active.store(true);
+    r->epoch.store(epoch);
+
+    // Step 2. Re-read in case the epoch advanced before the announcement
+    unsigned now = global_epoch.load();
+    if (now != epoch) {
+        r->epoch.store(now);
+    }
+}
+
+void EpochReclaimer::leave()
+{
+    record()->active.store(false, std::memory_order_release);
+}
+
+void EpochReclaimer::retire(Node* node)
+{
+    Record* r = record();
+
+    // Step 1. Read the global epoch after the node was unlinked. Every thread
+    // which can still see the node entered before this point, so it is
+    // safe to free once the global epoch moved two steps further.
+    unsigned epoch = global_epoch.load();
+
+    // Step 2. Free the buckets which became safe
+    for (int b=0; b < 3; b++) {
+        if (!r->retired[b].empty() && r->retired_epoch[b] + 2 <= epoch) {
+            free_bucket(r, b);
+        }
+    }
+
+    // Step 3. Keep the node in the bucket of the current epoch
+    r->retired[epoch % 3].push_back(node);
+    r->retired_epoch[epoch % 3] = epoch;
+
+    // Step 4. Try to move the epoch forward once enough garbage piled up
+    if (r->retired[epoch % 3].size() >= 64) {
+        try_advance();
+    }
+}
+
+void EpochReclaimer::try_advance()
+{
+    unsigned epoch = global_epoch.load();
+    for (int i=0; i < MAX_THREADS; i++) {
+        if (records[i].active.load() && records[i].epoch.load() != epoch) {
+            return; // Some thread is still in an older epoch
+        }
+    }
+    global_epoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+void EpochReclaimer::free_bucket(Record* r, int bucket)
+{
+    for (size_t i=0; i < r->retired[bucket].size(); i++) {
+        ::operator delete(r->retired[bucket][i]);
+    }
+    r->retired[bucket].clear();
+}
+
+/**
+ * Lock-free skip list implementation of an ordered set
+ */
+class LockFreeSkipList
+{
+    // Head and tail sentinels, compared by identity only
+    Node* head;
+    Node* tail;
+
+    // Reclaims the removed nodes
+    EpochReclaimer reclaimer;
+
+public:
+    // Constructor
+    LockFreeSkipList();
+
+    // Destructor
+    ~LockFreeSkipList();
+
+    // Insert an element
+    // Returns true if inserted, false if already present.
+    bool insert(int element);
+
+    // Delete an element
+    // Returns true if removed, false if not present.
+    bool remove(int element);
+
+    // Check if the element is present (wait-free)
+    bool contains(int element);
+
+    // Print the elements at level 0
+    // Not safe to call concurrently with writers.
+    void traverse(const std::string& msg);
+
+private:
+    // Allocate a node with the given number of levels
+    Node* create_node(int element, int level);
+
+    // Pick a random level with probability 1/4 to go one level up
+    int random_level();
+
+    // Find the nodes around the element on every level, unlinking marked nodes
+    // Returns true if the element is present.
+    bool find(int element, Node** preds, Node** succs);
+
+    // Drop one owner of the node, and retire it when it was the last one
+    void release(Node* node);
+};
+
+LockFreeSkipList::LockFreeSkipList()
+{
+    head = create_node(0, MAX_LEVEL);
+    tail = create_node(0, MAX_LEVEL);
+    for (int i=0; i < MAX_LEVEL; i++) {
+        head->next[i].store(link_of(tail));
+    }
+}
+
+LockFreeSkipList::~LockFreeSkipList()
+{
+    // Release the nodes still linked at level 0, the retired ones
+    // are freed by the reclaimer
+    Node* node = head;
+    while (node != NULL) {
+        Node* target = node;
+        node = (node == tail) ? NULL : pointer_of(node->next[0].load());
+        ::operator delete(target);
+    }
+}
+
+Node* LockFreeSkipList::create_node(int element, int level)
+{
+    // The node is allocated with room for all of its links
+    void* memory = ::operator new(sizeof(Node) + (level - 1) * sizeof(std::atomic<uintptr_t>));
+    Node* node = static_cast<Node*>(memory);
+    node->element = element;
+    node->level = level;
+    new (&node->owners) std::atomic<int>(2);
+    for (int i=0; i < level; i++) {
+        new (&node->next[i]) std::atomic<uintptr_t>(0);
+    }
+    return node;
+}
+
+int LockFreeSkipList::random_level()
+{
+    // xorshift random number generator, one per thread
+    static thread_local unsigned int seed =
+        2463534242u ^ (unsigned int)std::hash<std::thread::id>()(std::this_thread::get_id());
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    // Each pair of low bits being zero promotes the node one level
+    int lvl = 1;
+    unsigned int bits = seed;
+    while ((bits & 3) == 0 && lvl < MAX_LEVEL) {
+        lvl++;
+        bits >>= 2;
+    }
+    return lvl;
+}
+
+bool LockFreeSkipList::find(int element, Node** preds, Node** succs)
+{
+retry:
+    Node* pred = head;
+    for (int i=MAX_LEVEL-1; i >= 0; i--) {
+        Node* curr = pointer_of(pred->next[i].load());
+        while (true) {
+            // Step 1. Unlink the marked nodes following pred on this level.
+            // If pred itself got marked in the meantime, start over.
+            uintptr_t succ = curr->next[i].load();
+            while (is_marked(succ)) {
+                uintptr_t expected = link_of(curr);
+                if (!pred->next[i].compare_exchange_strong(expected, link_of(pointer_of(succ)))) {
+                    goto retry;
+                }
+                curr = pointer_of(succ);
+                succ = curr->next[i].load();
+            }
+
+            // Step 2. Move right while the elements are smaller
+            if (curr != tail && curr->element < element) {
+                pred = curr;
+                curr = pointer_of(succ);
+            } else {
+                break;
+            }
+        }
+        preds[i] = pred;
+        succs[i] = curr;
+    }
+    return succs[0] != tail && succs[0]->element == element;
+}
+
+bool LockFreeSkipList::insert(int element)
+{
+    EpochGuard guard(reclaimer);
+    Node* preds[MAX_LEVEL];
+    Node* succs[MAX_LEVEL];
+    int lvl = random_level();
+
+    while (true) {
+        // Step 1. Find the position, return if the element is already present
+        if (find(element, preds, succs)) {
+            return false;
+        }
+
+        // Step 2. Create the node pointing to its successors
+        Node* new_node = create_node(element, lvl);
+        for (int i=0; i < lvl; i++) {
+            new_node->next[i].store(link_of(succs[i]), std::memory_order_relaxed);
+        }
+
+        // Step 3. Link it at level 0. This makes the element present.
+        // If another thread changed pred meanwhile, the node was never
+        // visible and is deleted right away.
+        uintptr_t expected = link_of(succs[0]);
+        if (!preds[0]->next[0].compare_exchange_strong(expected, link_of(new_node))) {
+            ::operator delete(new_node);
+            continue;
+        }
+
+        // Step 4. Link the upper levels, refreshing preds and succs on conflict.
+        // Stop as soon as the node gets marked by a concurrent remove.
+        for (int i=1; i < lvl; i++) {
+            while (true) {
+                uintptr_t next = new_node->next[i].load();
+                if (is_marked(next)) {
+                    goto linked;
+                }
+                if (pointer_of(next) != succs[i] &&
+                    !new_node->next[i].compare_exchange_strong(next, link_of(succs[i]))) {
+                    continue;
+                }
+                expected = link_of(succs[i]);
+                if (preds[i]->next[i].compare_exchange_strong(expected, link_of(new_node))) {
+                    break;
+                }
+                find(element, preds, succs);
+                if (succs[0] != new_node) {
+                    goto linked; // Already removed
+                }
+            }
+        }
+
+    linked:
+        // Step 5. If a remove raced with the linking, unlink the levels
+        // it could not see, then hand the node over.
+        if (is_marked(new_node->next[0].load())) {
+            find(element, preds, succs);
+        }
+        release(new_node);
+        return true;
+    }
+}
+
+bool LockFreeSkipList::remove(int element)
+{
+    EpochGuard guard(reclaimer);
+    Node* preds[MAX_LEVEL];
+    Node* succs[MAX_LEVEL];
+
+    // Step 1. Find the node, return if the element is not present
+    if (!find(element, preds, succs)) {
+        return false;
+    }
+    Node* target = succs[0];
+
+    // Step 2. Mark the upper levels top-down
+    for (int i=target->level-1; i >= 1; i--) {
+        uintptr_t next = target->next[i].load();
+        while (!is_marked(next)) {
+            target->next[i].compare_exchange_weak(next, next | 1);
+        }
+    }
+
+    // Step 3. Mark level 0. The thread succeeding here removed the element.
+    uintptr_t next = target->next[0].load();
+    while (true) {
+        if (is_marked(next)) {
+            return false; // Another thread removed it first
+        }
+        if (target->next[0].compare_exchange_strong(next, next | 1)) {
+            break;
+        }
+    }
+
+    // Step 4. Unlink the node from every level, then hand it over
+    find(element, preds, succs);
+    release(target);
+    return true;
+}
+
+bool LockFreeSkipList::contains(int element)
+{
+    EpochGuard guard(reclaimer);
+
+    // Walk down the levels skipping the marked nodes, without helping
+    Node* pred = head;
+    Node* curr = NULL;
+    for (int i=MAX_LEVEL-1; i >= 0; i--) {
+        curr = pointer_of(pred->next[i].load(std::memory_order_acquire));
+        while (true) {
+            uintptr_t succ = curr->next[i].load(std::memory_order_acquire);
+            while (is_marked(succ)) {
+                curr = pointer_of(succ);
+                succ = curr->next[i].load(std::memory_order_acquire);
+            }
+            if (curr != tail && curr->element < element) {
+                pred = curr;
+                curr = pointer_of(succ);
+            } else {
+                break;
+            }
+        }
+    }
+    return curr != tail && curr->element == element && !is_marked(curr->next[0].load(std::memory_order_acquire));
+}
+
+void LockFreeSkipList::release(Node* node)
+{
+    // Both the inserter and the remover are done with the node: it is
+    // unlinked from every level and can be retired.
+    if (node->owners.fetch_sub(1) == 1) {
+        reclaimer.retire(node);
+    }
+}
+
+void LockFreeSkipList::traverse(const std::string& msg)
+{
+    cout << msg << endl;
+    cout << "HEAD ==> ";
+    for (Node* node = pointer_of(head->next[0].load()); node != tail; node = pointer_of(node->next[0].load())) {
+        if (!is_marked(node->next[0].load())) {
+            cout << node->element << " ==> ";
+        }
+    }
+    cout << "TAIL" << endl << endl;
+}
+
+// Run a mixed workload of 10% insert, 10% remove and 80% contains
+void benchmark(int threads, int ops, int key_range)
+{
+    LockFreeSkipList list;
+    for (int k=0; k < key_range; k += 2) {
+        list.insert(k);
+    }
+
+    auto worker = [&](int t) {
+        unsigned int x = 88172645u + t * 7919u;
+        for (int i=0; i < ops / threads; i++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            int key = x % key_range;
+            int op = (x >> 20) % 10;
+            if (op == 0) {
+                list.insert(key);
+            } else if (op == 1) {
+                list.remove(key);
+            } else {
+                list.contains(key);
+            }
+        }
+    };
+
+    auto start = chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t=0; t < threads; t++) {
+        pool.push_back(std::thread(worker, t));
+    }
+    for (size_t t=0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout.width(8);
+    cout << threads << " | ";
+    cout.width(10);
+    cout << (long long)(ops / ms * 1000) << endl;
+}
+
+int main()
+{
+    // Create a lock-free skip list
+    LockFreeSkipList list;
+
+    // Insert elements
+    list.insert(30);
+    list.insert(10);
+    list.insert(20);
+    cout << "insert(20) again returns " << list.insert(20) << endl;
+    list.traverse("insert(30), insert(10), insert(20)");
+
+    // Search elements
+    cout << "contains(20) returns " << list.contains(20) << endl;
+    cout << "contains(25) returns " << list.contains(25) << endl << endl;
+
+    // Delete elements
+    list.remove(20);
+    cout << "remove(20) again returns " << list.remove(20) << endl;
+    list.traverse("remove(20)");
+
+    // The extreme values are ordinary elements
+    cout << "contains(INT_MAX) on a list without it returns " << list.contains(INT_MAX) << endl;
+    list.insert(INT_MAX);
+    list.insert(INT_MIN);
+    list.traverse("insert(INT_MAX), insert(INT_MIN)");
+
+    // More short-lived threads than records: each exiting thread hands its record back
+    for (int t=0; t < 4 * MAX_THREADS; t++) {
+        std::thread([&list, t]() { list.insert(1000 + t); list.remove(1000 + t); }).join();
+    }
+    cout << 4 * MAX_THREADS << " short-lived threads done, contains(1000) returns " << list.contains(1000) << endl << endl;
+
+    // Concurrent workload over 64K keys
+    cout << " THREADS |    OPS/SEC" << endl;
+    cout << "---------+-----------" << endl;
+    for (int threads=1; threads <= 64; threads *= 2) {
+        benchmark(threads, 2000000, 65536);
+    }
+}
@@ -0,0 +1,331 @@
+/**
+ * Typed node pool shared by the linked list examples
+ *
+ * Nodes are carved out of large slab chunks instead of calling new/delete
+ * per element. Freed nodes go to a small thread-local cache first, and
+ * batches of them move between the cache and the shared free list, so the
+ * common insert/delete path takes no lock and never calls malloc.
+ * All chunks are released in bulk when the pool is destroyed.
+ *
+ * Each thread keeps a few caches, one per pool it recently used. A cache
+ * evicted to make room for another pool, or left behind when the thread
+ * exits, is returned to its pool's free list if the pool still exists.
+ */
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <set>
+
+template<class T>
+class NodePool
+{
+    // Number of nodes per slab chunk
+    static const size_t CHUNK_NODES = 1024;
+
+    // Number of nodes moved between the thread cache and the shared free list
+    static const size_t BATCH = 64;
+
+    // Number of pools a thread keeps a cache for at the same time
+    static const size_t CACHE_WAYS = 4;
+
+    // A free slot reuses the node memory to link the free list
+    union Slot
+    {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // Slab chunk holding many nodes
+    struct Chunk
+    {
+        Chunk* next;
+        Slot slots[CHUNK_NODES];
+    };
+
+    // Free nodes cached by the current thread for one pool
+    struct ThreadCache
+    {
+        unsigned long owner;
+        NodePool* pool;
+        Slot* head;
+        size_t count;
+    };
+
+    // Caches of the current thread, returned to their pools on thread exit
+    struct ThreadCaches
+    {
+        ThreadCache ways[CACHE_WAYS];
+        size_t victim;
+
+        ThreadCaches() : victim(0)
+        {
+            for (size_t i=0; i < CACHE_WAYS; i++) {
+                ways[i].owner = 0;
+                ways[i].pool = NULL;
+                ways[i].head = NULL;
+                ways[i].count = 0;
+            }
+        }
+
+        ~ThreadCaches()
+        {
+            for (size_t i=0; i < CACHE_WAYS; i++) {
+                release(ways[i]);
+            }
+        }
+    };
+
+    // All chunks allocated by this pool
+    Chunk* chunks;
+
+    // Shared free list
+    Slot* free_list;
+
+    // Number of slots handed out from the newest chunk
+    size_t chunk_used;
+
+    // Guards chunks, free_list and chunk_used
+    std::mutex lock;
+
+    // Unique pool id, so a cache never mixes nodes of different pools
+    unsigned long id;
+
+public:
+    // Constructor
+    NodePool() : chunks(NULL), free_list(NULL), chunk_used(CHUNK_NODES), id(next_id())
+    {
+        std::lock_guard<std::mutex> guard(registry_lock());
+        registry().insert(id);
+    }
+
+    // Destructor releases every chunk at once
+    ~NodePool();
+
+    // Allocate and construct a node
+    // Returns the new node
+    T* allocate();
+
+    // Destroy a node and return it to the pool
+    void deallocate(T* node);
+
+private:
+    NodePool(const NodePool&);
+    NodePool& operator=(const NodePool&);
+
+    // Returns the thread cache bound to this pool
+    ThreadCache& cache();
+
+    // Move a batch of free slots from the shared pool into the thread cache
+    void refill(ThreadCache& tc);
+
+    // Move a batch of free slots from the thread cache to the shared free list
+    void spill(ThreadCache& tc);
+
+    // Return all the slots of a cache to its pool if the pool still exists,
+    // and unbind the cache
+    static void release(ThreadCache& tc);
+
+    // Returns the caches of the current thread
+    static ThreadCaches& thread_caches()
+    {
+        static thread_local ThreadCaches caches;
+        return caches;
+    }
+
+    static unsigned long next_id()
+    {
+        static std::atomic<unsigned long> counter(0);
+        return ++counter;
+    }
+
+    // Ids of the live pools, guarded by registry_lock()
+    // A pool never leaves the registry while a cache is being released to it.
+    static std::set<unsigned long>& registry()
+    {
+        static std::set<unsigned long> ids;
+        return ids;
+    }
+
+    static std::mutex& registry_lock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+};
+
+template<class T>
+NodePool<T>::~NodePool()
+{
+    // Step 1. Leave the registry, so no thread returns slots to us anymore
+    {
+        std::lock_guard<std::mutex> guard(registry_lock());
+        registry().erase(id);
+    }
+
+    // Step 2. Forget the nodes cached by this thread, they live in our chunks.
+    // Caches of other threads are unbound when they are evicted.
+    ThreadCaches& caches = thread_caches();
+    for (size_t i=0; i < CACHE_WAYS; i++) {
+        if (caches.ways[i].owner == id) {
+            caches.ways[i].owner = 0;
+            caches.ways[i].head = NULL;
+            caches.ways[i].count = 0;
+        }
+    }
+
+    // Step 3. Free all the chunks
+    while (chunks != NULL) {
+        Chunk* target = chunks;
+        chunks = chunks->next;
+        delete target;
+    }
+}
+
+template<class T>
+typename NodePool<T>::ThreadCache& NodePool<T>::cache()
+{
+    ThreadCaches& caches = thread_caches();
+
+    // Step 1. Look for the cache already bound to this pool
+    for (size_t i=0; i < CACHE_WAYS; i++) {
+        if (caches.ways[i].owner == id) {
+            return caches.ways[i];
+        }
+    }
+
+    // Step 2. Otherwise take an unbound cache, or evict one in turn and
+    // hand its slots back to their pool
+    ThreadCache* tc = NULL;
+    for (size_t i=0; i < CACHE_WAYS && tc == NULL; i++) {
+        if (caches.ways[i].owner == 0) {
+            tc = &caches.ways[i];
+        }
+    }
+    if (tc == NULL) {
+        tc = &caches.ways[caches.victim];
+        caches.victim = (caches.victim + 1) % CACHE_WAYS;
+        release(*tc);
+    }
+
+    // Step 3. Bind the cache to this pool
+    tc->owner = id;
+    tc->pool = this;
+    return *tc;
+}
+
+template<class T>
+void NodePool<T>::release(ThreadCache& tc)
+{
+    if (tc.head != NULL) {
+        // The registry lock keeps the pool alive while the slots go back.
+        // If the pool was destroyed, its chunks took the slots with them.
+        std::lock_guard<std::mutex> registry_guard(registry_lock());
+        if (registry().count(tc.owner) != 0) {
+            Slot* last = tc.head;
+            while (last->next != NULL) {
+                last = last->next;
+            }
+            std::lock_guard<std::mutex> guard(tc.pool->lock);
+            last->next = tc.pool->free_list;
+            tc.pool->free_list = tc.head;
+        }
+    }
+    tc.owner = 0;
+    tc.pool = NULL;
+    tc.head = NULL;
+    tc.count = 0;
+}
+
+template<class T>
+T* NodePool<T>::allocate()
+{
+    // Step 1. Refill the thread cache if it is empty
+    ThreadCache& tc = cache();
+    if (tc.head == NULL) {
+        refill(tc);
+    }
+
+    // Step 2. Take the first free slot from the thread cache
+    Slot* slot = tc.head;
+    tc.head = slot->next;
+    tc.count--;
+
+    // Step 3. Construct the node in the slot
+    return new (slot->storage) T();
+}
+
+template<class T>
+void NodePool<T>::deallocate(T* node)
+{
+    // Step 1. Destroy the node
+    node->~T();
+
+    // Step 2. Push the slot into the thread cache
+    ThreadCache& tc = cache();
+    Slot* slot = reinterpret_cast<Slot*>(node);
+    slot->next = tc.head;
+    tc.head = slot;
+    tc.count++;
+
+    // Step 3. Return a batch to the shared list if the cache grew too large
+    if (tc.count >= 2 * BATCH) {
+        spill(tc);
+    }
+}
+
+template<class T>
+void NodePool<T>::refill(ThreadCache& tc)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    // Step 1. Take up to one batch from the shared free list
+    while (free_list != NULL && tc.count < BATCH) {
+        Slot* slot = free_list;
+        free_list = slot->next;
+        slot->next = tc.head;
+        tc.head = slot;
+        tc.count++;
+    }
+    if (tc.count > 0) {
+        return;
+    }
+
+    // Step 2. Otherwise carve a batch out of the newest chunk,
+    // allocating a new chunk if it is exhausted
+    if (chunk_used == CHUNK_NODES) {
+        Chunk* chunk = new Chunk;
+        chunk->next = chunks;
+        chunks = chunk;
+        chunk_used = 0;
+    }
+    for (size_t i=0; i < BATCH && chunk_used < CHUNK_NODES; i++) {
+        Slot* slot = &chunks->slots[chunk_used++];
+        slot->next = tc.head;
+        tc.head = slot;
+        tc.count++;
+    }
+}
+
+template<class T>
+void NodePool<T>::spill(ThreadCache& tc)
+{
+    // Step 1. Detach one batch from the thread cache without holding the lock
+    Slot* first = tc.head;
+    Slot* last = first;
+    for (size_t i=1; i < BATCH; i++) {
+        last = last->next;
+    }
+    tc.head = last->next;
+    tc.count -= BATCH;
+
+    // Step 2. Link the batch in front of the shared free list
+    std::lock_guard<std::mutex> guard(lock);
+    last->next = free_list;
+    free_list = first;
+}
+
+#endif // NODE_POOL_H
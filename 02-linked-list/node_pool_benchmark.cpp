@@ -0,0 +1,178 @@
+/**
+ * C++ example to benchmark the node pool against new/delete
+ *
+ * A list of nodes is kept at a steady size while random nodes are
+ * deleted and new ones inserted (insert/delete churn), once with the
+ * nodes allocated by new/delete and once from a NodePool.
+ *
+ * It also checks that the heap stays flat when a thread alternates between
+ * several pools, or when short-lived threads use a pool, so the slots in
+ * the thread caches always find their way back to their pool. The heap is
+ * measured with glibc's mallinfo2().
+ *
+ * Compile with: g++ -std=c++17 -O2 -pthread node_pool_benchmark.cpp
+ */
+#include <chrono>
+#include <iostream>
+#include <malloc.h>
+#include <random>
+#include <thread>
+#include "node_pool.h"
+using namespace std;
+
+// Linked list node representation
+struct Node
+{
+    int element;
+    Node* next;
+};
+
+// Allocate nodes with new/delete
+struct HeapAllocator
+{
+    Node* allocate() { return new Node(); }
+    void deallocate(Node* node) { delete node; }
+};
+
+// Allocate nodes from the node pool
+struct PoolAllocator
+{
+    NodePool<Node> pool;
+    Node* allocate() { return pool.allocate(); }
+    void deallocate(Node* node) { pool.deallocate(node); }
+};
+
+// Run the churn on a list of the given size and return the time in ms
+template<class Allocator>
+double churn(Allocator& allocator, int size, int rounds)
+{
+    std::mt19937 rng(42);
+
+    auto start = chrono::steady_clock::now();
+
+    // Step 1. Build the initial list
+    Node* head = NULL;
+    for (int i=0; i < size; i++) {
+        Node* node = allocator.allocate();
+        node->element = i;
+        node->next = head;
+        head = node;
+    }
+
+    // Step 2. Repeatedly delete a batch of nodes after random positions,
+    // and insert the same number back in front
+    for (int r=0; r < rounds; r++) {
+        int deleted = 0;
+        for (Node* node = head; node != NULL; node = node->next) {
+            if (rng() % 4 == 0 && node->next != NULL) {
+                Node* target = node->next;
+                node->next = target->next;
+                allocator.deallocate(target);
+                deleted++;
+            }
+        }
+        for (int i=0; i < deleted; i++) {
+            Node* node = allocator.allocate();
+            node->element = r;
+            node->next = head;
+            head = node;
+        }
+    }
+
+    // Step 3. Release the list
+    while (head != NULL) {
+        Node* target = head;
+        head = head->next;
+        allocator.deallocate(target);
+    }
+
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+// Returns the number of bytes currently allocated from the heap
+size_t heap_in_use()
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// Allocate and free one node from each pool in turn, the given number of rounds
+// Returns the growth of the heap in bytes after the first round
+long long alternate(int pools, int rounds)
+{
+    NodePool<int>* pool[8];
+    for (int p=0; p < pools; p++) {
+        pool[p] = new NodePool<int>();
+    }
+
+    long long before = 0;
+    for (int r=0; r < rounds; r++) {
+        for (int p=0; p < pools; p++) {
+            pool[p]->deallocate(pool[p]->allocate());
+        }
+        if (r == 0) {
+            before = (long long)heap_in_use();
+        }
+    }
+    long long growth = (long long)heap_in_use() - before;
+
+    for (int p=0; p < pools; p++) {
+        delete pool[p];
+    }
+    return growth;
+}
+
+// Allocate and free nodes of one pool from the given number of short-lived threads
+// Returns the growth of the heap in bytes after the first thread
+long long short_lived_threads(int threads)
+{
+    NodePool<int> pool;
+    long long before = 0;
+    for (int t=0; t < threads; t++) {
+        std::thread([&]() {
+            int* nodes[100];
+            for (int i=0; i < 100; i++) {
+                nodes[i] = pool.allocate();
+            }
+            for (int i=0; i < 100; i++) {
+                pool.deallocate(nodes[i]);
+            }
+        }).join();
+        if (t == 0) {
+            before = (long long)heap_in_use();
+        }
+    }
+    return (long long)heap_in_use() - before;
+}
+
+// The main function to begin the execution
+int main()
+{
+    // The heap must not grow with the number of rounds or threads
+    cout << "Heap growth, 2 pools alternated 200000 times: " << alternate(2, 200000) << " bytes" << endl;
+    cout << "Heap growth, 6 pools alternated 200000 times: " << alternate(6, 200000) << " bytes" << endl;
+    cout << "Heap growth, 1000 short-lived threads: " << short_lived_threads(1000) << " bytes" << endl;
+    cout << endl;
+
+    const int sizes[] = { 1000, 100000, 1000000 };
+
+    cout << "      SIZE |  NEW/DELETE |   NODE POOL" << endl;
+    cout << "-----------+-------------+------------" << endl;
+    for (int size : sizes) {
+        int rounds = 20000000 / size;
+
+        HeapAllocator heap;
+        double heap_ms = churn(heap, size, rounds);
+
+        PoolAllocator pool;
+        double pool_ms = churn(pool, size, rounds);
+
+        cout.width(10);
+        cout << size << " | ";
+        cout.width(8);
+        cout << heap_ms << " ms | ";
+        cout.width(7);
+        cout << pool_ms << " ms" << endl;
+    }
+}
@@ -1,7 +1,13 @@
 /**
  * C++ example to demonstrate the Singly Linked List
  */
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "node_pool.h"
 using namespace std;
 
 // Linked list node representation
@@ -19,9 +25,16 @@ class List
     // Head of the list
     Node* head;
 
+    // Node pool to allocate from, or NULL to use new/delete
+    NodePool<Node>* pool;
+
 public:
     // Constructor
-    List() : head(NULL) {}
+    // The nodes are allocated from the given pool if any
+    List(NodePool<Node>* pool = NULL) : head(NULL), pool(pool) {}
+
+    // Destructor
+    ~List();
 
     // Insert an element in front of the list
     // Returns the new node inserted
@@ -48,12 +61,71 @@ public:
 
     // Traverse the elements
     void traverse(const std::string& msg);
+
+    // Sort the elements in ascending order, keeping equal elements in order
+    // Bottom-up merge sort: O(n log n), no recursion and no allocation.
+    void sort();
+
+    // Move the nodes after before_first up to last (inclusive) from the
+    // other list, and link them after pos. A NULL before_first takes the
+    // range from the front of other, a NULL pos links it at the front.
+    // Throws runtime_error if the lists use different node pools.
+    void splice_after(Node* pos, List& other, Node* before_first, Node* last);
+
+    // Merge the sorted other list into this sorted list in linear time
+    // The other list becomes empty.
+    // Throws runtime_error if the lists use different node pools.
+    void merge(List& other);
+
+    // Benchmark reads the nodes directly
+    friend void benchmark_sort(int size);
+
+private:
+    List(const List&);
+    List& operator=(const List&);
+
+    // Allocate a new node from the pool if available, with new otherwise
+    Node* create_node();
+
+    // Release the node to the pool if available, with delete otherwise
+    void destroy_node(Node* node);
+
+    // Merge two sorted runs of nodes
+    // Returns the first node of the merged run
+    static Node* merge_runs(Node* a, Node* b);
 };
 
+List::~List()
+{
+    // Release the nodes from front to end
+    while (head != NULL) {
+        Node* target = head;
+        head = head->next;
+        destroy_node(target);
+    }
+}
+
+Node* List::create_node()
+{
+    if (pool != NULL) {
+        return pool->allocate();
+    }
+    return new Node();
+}
+
+void List::destroy_node(Node* node)
+{
+    if (pool != NULL) {
+        pool->deallocate(node);
+        return;
+    }
+    delete node;
+}
+
 Node* List::insert_front(int element)
 {
     // Step 1. Create the new node
-    Node* new_node = new Node();
+    Node* new_node = create_node();
     new_node->element = element;
 
     // Step 2. Link before the head node
@@ -68,7 +140,7 @@ Node* List::insert_front(int element)
 Node* List::insert_after(Node* prev, int element)
 {
     // Step 1. Create the new node
-    Node *new_node = new Node();
+    Node *new_node = create_node();
     new_node->element = element;
 
     // Step 2. Link the new node after the given node
@@ -91,7 +163,7 @@ Node* List::delete_front()
     head = head->next;
 
     // Step 3. Delete the target node
-    delete target;
+    destroy_node(target);
 
     return head;
 }
@@ -111,7 +183,7 @@ Node* List::delete_after(Node* prev)
     prev->next = target->next;
 
     // Step 4. Delete the target node
-    delete target;
+    destroy_node(target);
 
     return prev->next;
 }
@@ -141,7 +213,7 @@ void List::remove(int element)
             node->next = node->next->next;
             
             // Step 5. Delete the target node
-            delete target;
+            destroy_node(target);
             return;
         }
     }
@@ -162,6 +234,105 @@ Node* List::search(int element)
     return NULL; // Not found
 }
 
+Node* List::merge_runs(Node* a, Node* b)
+{
+    // Repeatedly link the smaller front node of both runs.
+    // On equal elements the node of the first run goes first.
+    Node* result = NULL;
+    Node** link = &result;
+    while (a != NULL && b != NULL) {
+        if (b->element < a->element) {
+            *link = b;
+            b = b->next;
+        } else {
+            *link = a;
+            a = a->next;
+        }
+        link = &(*link)->next;
+    }
+
+    // Link the rest of the run which is not exhausted
+    *link = (a != NULL) ? a : b;
+    return result;
+}
+
+void List::sort()
+{
+    // bins[i] holds a sorted run of 2^i nodes, or NULL
+    Node* bins[64] = { NULL };
+    int bin_count = 0;
+
+    // Step 1. Take the nodes one by one from the front. Like a binary
+    // counter, merge the new node with the runs of bins 0, 1, 2, ...
+    // as long as they are occupied, then store the result in the first
+    // empty bin. Recently merged runs are still in cache when merged again.
+    while (head != NULL) {
+        Node* run = head;
+        head = head->next;
+        run->next = NULL;
+
+        int i = 0;
+        while (i < bin_count && bins[i] != NULL) {
+            // The older run goes first, so that the sort is stable
+            run = merge_runs(bins[i], run);
+            bins[i] = NULL;
+            i++;
+        }
+        bins[i] = run;
+        if (i == bin_count) {
+            bin_count++;
+        }
+    }
+
+    // Step 2. Merge the remaining runs, from the newest to the oldest
+    Node* result = NULL;
+    for (int i=0; i < bin_count; i++) {
+        if (bins[i] != NULL) {
+            result = merge_runs(bins[i], result);
+        }
+    }
+    head = result;
+}
+
+void List::splice_after(Node* pos, List& other, Node* before_first, Node* last)
+{
+    // Step 1. Check if both lists release their nodes the same way
+    if (pool != other.pool) {
+        throw std::runtime_error("lists use different node pools");
+    }
+
+    // Step 2. Detach the range from the other list
+    Node* first;
+    if (before_first == NULL) {
+        first = other.head;
+        other.head = last->next;
+    } else {
+        first = before_first->next;
+        before_first->next = last->next;
+    }
+
+    // Step 3. Link the range after pos, or at the front
+    if (pos == NULL) {
+        last->next = head;
+        head = first;
+    } else {
+        last->next = pos->next;
+        pos->next = first;
+    }
+}
+
+void List::merge(List& other)
+{
+    // Step 1. Check if both lists release their nodes the same way
+    if (pool != other.pool) {
+        throw std::runtime_error("lists use different node pools");
+    }
+
+    // Step 2. Merge the nodes of both lists, and empty the other list
+    head = merge_runs(head, other.head);
+    other.head = NULL;
+}
+
 void List::traverse(const std::string& msg)
 {
     cout << msg << endl;
@@ -173,6 +344,47 @@ void List::traverse(const std::string& msg)
     cout << "NULL" << endl << endl;
 }
 
+// Compare sort() against copying into a vector, sorting and rebuilding
+void benchmark_sort(int size)
+{
+    std::mt19937 rng(42);
+    std::vector<int> elements(size);
+    for (int i=0; i < size; i++) {
+        elements[i] = rng() % size;
+    }
+
+    // In-place merge sort
+    List list;
+    for (int i=0; i < size; i++) {
+        list.insert_front(elements[i]);
+    }
+    auto start = chrono::steady_clock::now();
+    list.sort();
+    double sort_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Copy into a vector, sort it, and rebuild the list
+    List copy;
+    for (int i=0; i < size; i++) {
+        copy.insert_front(elements[i]);
+    }
+    start = chrono::steady_clock::now();
+    std::vector<int> buffer;
+    buffer.reserve(size);
+    for (Node* node = copy.head; node != NULL; node = node->next) {
+        buffer.push_back(node->element);
+    }
+    while (copy.delete_front() != NULL) {
+    }
+    std::sort(buffer.begin(), buffer.end());
+    for (int i=size-1; i >= 0; i--) {
+        copy.insert_front(buffer[i]);
+    }
+    double copy_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "Sorting " << size << " elements: sort() " << sort_ms << " ms, copy-sort-rebuild "
+         << copy_ms << " ms" << endl;
+}
+
 int main()
 {
     // Create a linked list
@@ -202,4 +414,29 @@ int main()
     
     list.remove(15);
     list.traverse("remove(15)");
+
+    // Sort, splice and merge
+    List a;
+    List b;
+    for (int element : { 40, 10, 30, 20 }) {
+        a.insert_front(element);
+    }
+    for (int element : { 35, 5, 25 }) {
+        b.insert_front(element);
+    }
+    a.sort();
+    a.traverse("list a after sort()");
+    b.sort();
+    b.traverse("list b after sort()");
+
+    a.merge(b);
+    a.traverse("list a after a.merge(b)");
+
+    Node* node_20 = a.search(20);
+    Node* node_30 = a.search(30);
+    b.splice_after(NULL, a, node_20, node_30);
+    a.traverse("list a after b.splice_after(NULL, a, node_20, node_30)");
+    b.traverse("list b after b.splice_after(NULL, a, node_20, node_30)");
+
+    benchmark_sort(1000000);
 }
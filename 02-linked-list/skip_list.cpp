@@ -0,0 +1,446 @@
+/**
+ * C++ example to demonstrate the Skip List
+ *
+ * A skip list is a sorted singly linked list with extra express lanes.
+ * Every node gets a random number of levels, and the link of level i
+ * skips over all the nodes having less than i+1 levels. Search walks
+ * down the levels and takes O(log n) expected steps, while insert and
+ * delete stay as cheap as relinking a few list pointers.
+ *
+ * Compile with: g++ -std=c++17 -O2 skip_list.cpp
+ */
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <vector>
+using namespace std;
+
+// Maximum number of levels
+#define MAX_LEVEL 24
+
+// Skip list node representation
+// The links of all levels are stored inline right after the element,
+// so a node is one allocation and its links share the cache line.
+struct Node
+{
+    int element;
+    int level;     // Number of links in next[]
+    Node* next[1]; // next[i] is the following node at level i
+};
+
+/**
+ * Skip list implementation
+ */
+class SkipList
+{
+    // Head node with MAX_LEVEL links, it holds no element
+    Node* head;
+
+    // Number of levels in use
+    int level;
+
+    // State of the random generator for node levels
+    unsigned int seed;
+
+public:
+    // Constructor
+    SkipList();
+
+    // Destructor
+    ~SkipList();
+
+    // Build the list from elements in ascending order in O(n)
+    // Throws runtime_error if the list is not empty or the input is not sorted
+    void build(const int* elements, int count);
+
+    // Insert an element in its sorted position
+    // Returns the new node inserted
+    Node* insert(int element);
+
+    // Search and delete the given element
+    // Returns true on success, false otherwise.
+    bool remove(int element);
+
+    // Search an element from the list
+    // Returns the matching node if found, NULL otherwise.
+    Node* search(int element);
+
+    // Find the first element not less than the given element
+    // Returns the node if found, NULL otherwise.
+    // The following elements are reached through node->next[0].
+    Node* lower_bound(int element);
+
+    // Print the elements in the range [low, high)
+    void traverse_range(int low, int high, const std::string& msg);
+
+    // Print every level of the list
+    void traverse(const std::string& msg);
+
+private:
+    // Allocate a node with the given number of levels
+    Node* create_node(int element, int level);
+
+    // Release a node
+    void destroy_node(Node* node);
+
+    // Pick a random level with probability 1/4 to go one level up
+    int random_level();
+
+    // Find the last node before the element on every level
+    // Returns the first node not less than the element at level 0
+    Node* find(int element, Node** update);
+};
+
+SkipList::SkipList() : level(1), seed(2463534242u)
+{
+    head = create_node(0, MAX_LEVEL);
+}
+
+SkipList::~SkipList()
+{
+    // Release the nodes from front to end at level 0
+    Node* node = head;
+    while (node != NULL) {
+        Node* target = node;
+        node = node->next[0];
+        destroy_node(target);
+    }
+}
+
+Node* SkipList::create_node(int element, int level)
+{
+    // The node is allocated with room for all of its links
+    void* memory = ::operator new(sizeof(Node) + (level - 1) * sizeof(Node*));
+    Node* node = static_cast<Node*>(memory);
+    node->element = element;
+    node->level = level;
+    for (int i=0; i < level; i++) {
+        node->next[i] = NULL;
+    }
+    return node;
+}
+
+void SkipList::destroy_node(Node* node)
+{
+    ::operator delete(node);
+}
+
+int SkipList::random_level()
+{
+    // xorshift random number generator
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    // Each pair of low bits being zero promotes the node one level
+    int lvl = 1;
+    unsigned int bits = seed;
+    while ((bits & 3) == 0 && lvl < MAX_LEVEL) {
+        lvl++;
+        bits >>= 2;
+    }
+    return lvl;
+}
+
+Node* SkipList::find(int element, Node** update)
+{
+    // Start at the top level of the head and move right while the
+    // next element is smaller, then go one level down.
+    Node* node = head;
+    for (int i=level-1; i >= 0; i--) {
+        while (node->next[i] != NULL && node->next[i]->element < element) {
+            node = node->next[i];
+        }
+        if (update != NULL) {
+            update[i] = node;
+        }
+    }
+    return node->next[0];
+}
+
+void SkipList::build(const int* elements, int count)
+{
+    // Step 1. Check if the list is empty. If not, return error.
+    if (head->next[0] != NULL) {
+        throw std::runtime_error("skip list is not empty");
+    }
+
+    // Step 2. Remember the last node of every level
+    Node* tail[MAX_LEVEL];
+    for (int i=0; i < MAX_LEVEL; i++) {
+        tail[i] = head;
+    }
+
+    // Step 3. Append the nodes in order, linking each level after its tail
+    for (int n=0; n < count; n++) {
+        if (n > 0 && elements[n] < elements[n-1]) {
+            throw std::runtime_error("input is not sorted");
+        }
+        int lvl = random_level();
+        Node* node = create_node(elements[n], lvl);
+        for (int i=0; i < lvl; i++) {
+            tail[i]->next[i] = node;
+            tail[i] = node;
+        }
+        level = std::max(level, lvl);
+    }
+}
+
+Node* SkipList::insert(int element)
+{
+    // Step 1. Find the node before the new element on every level
+    Node* update[MAX_LEVEL];
+    find(element, update);
+
+    // Step 2. Pick the level of the new node. If it is higher than the
+    // list, the head is the previous node on the new levels.
+    int lvl = random_level();
+    for (int i=level; i < lvl; i++) {
+        update[i] = head;
+    }
+    level = std::max(level, lvl);
+
+    // Step 3. Link the new node after the previous node on each of its levels
+    Node* new_node = create_node(element, lvl);
+    for (int i=0; i < lvl; i++) {
+        new_node->next[i] = update[i]->next[i];
+        update[i]->next[i] = new_node;
+    }
+    return new_node;
+}
+
+bool SkipList::remove(int element)
+{
+    // Step 1. Find the node before the element on every level
+    Node* update[MAX_LEVEL];
+    Node* target = find(element, update);
+
+    // Step 2. Check if the element exists. Return if not found.
+    if (target == NULL || target->element != element) {
+        return false;
+    }
+
+    // Step 3. Unlink the target node from all of its levels
+    for (int i=0; i < target->level; i++) {
+        update[i]->next[i] = target->next[i];
+    }
+
+    // Step 4. Drop the levels which became empty
+    while (level > 1 && head->next[level-1] == NULL) {
+        level--;
+    }
+
+    // Step 5. Delete the target node
+    destroy_node(target);
+    return true;
+}
+
+Node* SkipList::search(int element)
+{
+    Node* node = find(element, NULL);
+    if (node != NULL && node->element == element) {
+        return node; // Found element
+    }
+    return NULL; // Not found
+}
+
+Node* SkipList::lower_bound(int element)
+{
+    return find(element, NULL);
+}
+
+void SkipList::traverse_range(int low, int high, const std::string& msg)
+{
+    cout << msg << endl;
+    // Start at the first element in range and follow level 0
+    for (Node* node = lower_bound(low); node != NULL && node->element < high; node = node->next[0]) {
+        cout << node->element << " ";
+    }
+    cout << endl << endl;
+}
+
+void SkipList::traverse(const std::string& msg)
+{
+    cout << msg << endl;
+    // Print the levels from top to bottom
+    for (int i=level-1; i >= 0; i--) {
+        cout << "L" << i << ": HEAD ==> ";
+        for (Node* node = head->next[i]; node != NULL; node = node->next[i]) {
+            cout << node->element << " ==> ";
+        }
+        cout << "NULL" << endl;
+    }
+    cout << endl;
+}
+
+// AVL tree node, used for comparison
+struct AVLNode
+{
+    int data;
+    AVLNode* left;
+    AVLNode* right;
+    int height;
+};
+
+// Minimal AVL tree with insert and search, used for comparison
+struct AVLTree
+{
+    AVLNode* root = NULL;
+
+    static int height(AVLNode* p) { return p == NULL ? 0 : p->height; }
+
+    static void update(AVLNode* p) { p->height = 1 + std::max(height(p->left), height(p->right)); }
+
+    static AVLNode* left_rotate(AVLNode* p)
+    {
+        AVLNode* parent = p->right;
+        p->right = parent->left;
+        parent->left = p;
+        update(p);
+        update(parent);
+        return parent;
+    }
+
+    static AVLNode* right_rotate(AVLNode* p)
+    {
+        AVLNode* parent = p->left;
+        p->left = parent->right;
+        parent->right = p;
+        update(p);
+        update(parent);
+        return parent;
+    }
+
+    static AVLNode* insert(AVLNode* p, int data)
+    {
+        if (p == NULL) {
+            return new AVLNode{ data, NULL, NULL, 1 };
+        }
+        if (data < p->data) {
+            p->left = insert(p->left, data);
+        } else {
+            p->right = insert(p->right, data);
+        }
+        update(p);
+
+        int bf = height(p->right) - height(p->left);
+        if (bf > 1) {
+            if (data < p->right->data) {
+                p->right = right_rotate(p->right);
+            }
+            return left_rotate(p);
+        }
+        if (bf < -1) {
+            if (data >= p->left->data) {
+                p->left = left_rotate(p->left);
+            }
+            return right_rotate(p);
+        }
+        return p;
+    }
+
+    static void destroy(AVLNode* p)
+    {
+        if (p != NULL) {
+            destroy(p->left);
+            destroy(p->right);
+            delete p;
+        }
+    }
+
+    ~AVLTree() { destroy(root); }
+
+    void insert(int data) { root = insert(root, data); }
+
+    AVLNode* search(int data)
+    {
+        AVLNode* p = root;
+        while (p != NULL && p->data != data) {
+            p = (data < p->data) ? p->left : p->right;
+        }
+        return p;
+    }
+};
+
+// Compare insert and search throughput against the AVL tree
+void benchmark(int count)
+{
+    // Random keys to insert and search
+    std::vector<int> keys(count);
+    unsigned int x = 12345;
+    for (int i=0; i < count; i++) {
+        x = x * 1103515245u + 12345u;
+        keys[i] = (int)(x >> 1);
+    }
+
+    SkipList list;
+    AVLTree tree;
+
+    auto start = chrono::steady_clock::now();
+    for (int i=0; i < count; i++) {
+        list.insert(keys[i]);
+    }
+    double list_insert = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int i=0; i < count; i++) {
+        tree.insert(keys[i]);
+    }
+    double tree_insert = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    std::reverse(keys.begin(), keys.end());
+    long long found = 0;
+
+    start = chrono::steady_clock::now();
+    for (int i=0; i < count; i++) {
+        found += (list.search(keys[i]) != NULL);
+    }
+    double list_search = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int i=0; i < count; i++) {
+        found -= (tree.search(keys[i]) != NULL);
+    }
+    double tree_search = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "Benchmark with " << count << " random keys (checksum " << found << ")" << endl;
+    cout << "  insert: SkipList " << list_insert << " ms, AVLTree " << tree_insert << " ms" << endl;
+    cout << "  search: SkipList " << list_search << " ms, AVLTree " << tree_search << " ms" << endl;
+}
+
+int main()
+{
+    // Create a skip list
+    SkipList list;
+
+    // Insert elements
+    int elements[] = { 30, 10, 50, 20, 60, 40, 80, 70, 90 };
+    for (int element : elements) {
+        list.insert(element);
+    }
+    list.traverse("insert 30, 10, 50, 20, 60, 40, 80, 70, 90");
+
+    // Search an element
+    Node* node_60 = list.search(60);
+    cout << "search(60) matches node " << node_60->element << endl;
+    cout << "search(65) returns " << (list.search(65) == NULL ? "NULL" : "node") << endl;
+    cout << "lower_bound(65) matches node " << list.lower_bound(65)->element << endl << endl;
+
+    // Range iteration
+    list.traverse_range(25, 75, "traverse_range(25, 75)");
+
+    // Delete elements
+    list.remove(10);
+    list.remove(60);
+    list.traverse("remove(10) and remove(60)");
+
+    // Bulk construction from sorted input
+    int sorted[] = { 1, 2, 3, 5, 8, 13, 21, 34, 55, 89 };
+    SkipList fib;
+    fib.build(sorted, 10);
+    fib.traverse("build() from 1, 2, 3, 5, 8, 13, 21, 34, 55, 89");
+
+    benchmark(1000000);
+}
@@ -0,0 +1,398 @@
+/**
+ * C++ example to demonstrate the Unrolled Linked List
+ *
+ * Every node stores up to K elements and fills exactly one cache line,
+ * so a traversal touches one node (one cache miss) per K elements
+ * instead of per element. Inserting into a full node splits it in two,
+ * and a node that falls below half full is merged with its successor.
+ *
+ * Compile with: g++ -std=c++17 -O2 unrolled_linked_list.cpp
+ */
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+// Size of a cache line in bytes
+#define CACHE_LINE 64
+
+// Number of elements per node, so that the node fills one cache line
+#define K ((CACHE_LINE - sizeof(void*) - sizeof(int)) / sizeof(int))
+
+// Linked list node representation
+struct alignas(CACHE_LINE) Node
+{
+    int elements[K];
+    int count;
+    Node* next;
+};
+
+// Position of an element in the list
+struct Position
+{
+    Node* node;
+    int index;
+};
+
+/**
+ * Unrolled linked list implementation
+ */
+class UnrolledList
+{
+    // Head of the list
+    Node* head;
+
+public:
+    // Constructor
+    UnrolledList() : head(NULL) {}
+
+    // Destructor
+    ~UnrolledList();
+
+    // Insert an element in front of the list
+    // Returns the position of the new element
+    Position insert_front(int element);
+
+    // Insert an element after the given position
+    // Returns the position of the new element
+    Position insert_after(Position prev, int element);
+
+    // Delete the front element
+    // Returns the position of the next element if available, {NULL, 0} otherwise.
+    Position delete_front();
+
+    // Delete the element after the given position
+    // Returns the position of the next element if available, {NULL, 0} otherwise.
+    Position delete_after(Position prev);
+
+    // Search and delete the given element
+    void remove(int element);
+
+    // Search an element from the list
+    // Returns the matching position if found, {NULL, 0} otherwise.
+    Position search(int element);
+
+    // Traverse the elements
+    void traverse(const std::string& msg);
+
+    // Benchmark walks the nodes directly
+    friend void benchmark(int size, int searches);
+
+private:
+    // Insert an element at the given index of a node, splitting it if full
+    Position insert_at(Node* node, int index, int element);
+
+    // Delete the element at the given index of a node, merging the node
+    // with its successor if it becomes less than half full
+    Position delete_at(Node* prev_node, Node* node, int index);
+};
+
+UnrolledList::~UnrolledList()
+{
+    // Release the nodes from front to end
+    while (head != NULL) {
+        Node* target = head;
+        head = head->next;
+        delete target;
+    }
+}
+
+Position UnrolledList::insert_front(int element)
+{
+    // Step 1. Check if the list is empty. If true, create the first node.
+    if (head == NULL) {
+        head = new Node();
+        head->elements[0] = element;
+        head->count = 1;
+        head->next = NULL;
+        Position pos = { head, 0 };
+        return pos;
+    }
+
+    // Step 2. Otherwise insert at the first index of the head node
+    return insert_at(head, 0, element);
+}
+
+Position UnrolledList::insert_after(Position prev, int element)
+{
+    return insert_at(prev.node, prev.index + 1, element);
+}
+
+Position UnrolledList::insert_at(Node* node, int index, int element)
+{
+    // Step 1. Check if the node is full. If true, split it by moving
+    // the second half of the elements into a new node. When appending at
+    // the end of the node, nothing is moved so that sequential inserts
+    // leave the nodes full.
+    if (node->count == (int)K) {
+        Node* new_node = new Node();
+        int half = (index == (int)K) ? K : K / 2;
+        for (int i=half; i < (int)K; i++) {
+            new_node->elements[i - half] = node->elements[i];
+        }
+        new_node->count = K - half;
+        node->count = half;
+
+        new_node->next = node->next;
+        node->next = new_node;
+
+        // The element goes into the new node if it is beyond the first half
+        if (index > half || index == (int)K) {
+            node = new_node;
+            index -= half;
+        }
+    }
+
+    // Step 2. Free up the index by shifting the elements to next position
+    for (int i=node->count; i > index; i--) {
+        node->elements[i] = node->elements[i-1];
+    }
+
+    // Step 3. Insert the new element
+    node->elements[index] = element;
+    node->count++;
+
+    Position pos = { node, index };
+    return pos;
+}
+
+Position UnrolledList::delete_front()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (head == NULL) {
+        Position none = { NULL, 0 };
+        return none;
+    }
+
+    // Step 2. Delete the first element of the head node
+    return delete_at(NULL, head, 0);
+}
+
+Position UnrolledList::delete_after(Position prev)
+{
+    // Step 1. Check if the target element is in the same node
+    if (prev.index + 1 < prev.node->count) {
+        return delete_at(NULL, prev.node, prev.index + 1);
+    }
+
+    // Step 2. Otherwise the target is the first element of the next node
+    if (prev.node->next == NULL) {
+        Position none = { NULL, 0 };
+        return none;
+    }
+    return delete_at(prev.node, prev.node->next, 0);
+}
+
+Position UnrolledList::delete_at(Node* prev_node, Node* node, int index)
+{
+    // Step 1. Delete the element by shifting the elements to previous position
+    for (int i=index; i < node->count - 1; i++) {
+        node->elements[i] = node->elements[i+1];
+    }
+    node->count--;
+
+    // Step 2. Check if the node became empty. If true, unlink and delete it.
+    if (node->count == 0) {
+        Node* next_node = node->next;
+        if (prev_node == NULL) {
+            head = next_node;
+        } else {
+            prev_node->next = next_node;
+        }
+        delete node;
+
+        Position pos = { next_node, 0 };
+        return pos;
+    }
+
+    // Step 3. Check if the node is less than half full and has a successor.
+    // If true, merge the successor into it when both fit in one node,
+    // or borrow elements from the successor otherwise.
+    Node* next_node = node->next;
+    if (node->count < (int)K / 2 && next_node != NULL) {
+        if (node->count + next_node->count <= (int)K) {
+            for (int i=0; i < next_node->count; i++) {
+                node->elements[node->count++] = next_node->elements[i];
+            }
+            node->next = next_node->next;
+            delete next_node;
+        } else {
+            int moved = K / 2 - node->count;
+            for (int i=0; i < moved; i++) {
+                node->elements[node->count++] = next_node->elements[i];
+            }
+            for (int i=moved; i < next_node->count; i++) {
+                next_node->elements[i - moved] = next_node->elements[i];
+            }
+            next_node->count -= moved;
+        }
+    }
+
+    // Step 4. Return the position of the element which followed the deleted one
+    if (index < node->count) {
+        Position pos = { node, index };
+        return pos;
+    }
+    Position pos = { node->next, 0 };
+    return pos;
+}
+
+void UnrolledList::remove(int element)
+{
+    // Step 1. Iterate the nodes from start to end, remembering the previous node
+    Node* prev_node = NULL;
+    for (Node* node = head ; node != NULL ; node = node->next) {
+        // Step 2. Search the element within the node. If found, delete it and return.
+        for (int i=0; i < node->count; i++) {
+            if (node->elements[i] == element) {
+                delete_at(prev_node, node, i);
+                return;
+            }
+        }
+        prev_node = node;
+    }
+}
+
+Position UnrolledList::search(int element)
+{
+    // Step 1. Iterate the nodes from start to end
+    for (Node* node = head ; node != NULL ; node = node->next) {
+        // Step 2. Check the elements within the node, and return the position if found.
+        for (int i=0; i < node->count; i++) {
+            if (node->elements[i] == element) {
+                Position pos = { node, i };
+                return pos; // Found element
+            }
+        }
+    }
+    // Step 3. Return {NULL, 0} if none matches.
+    Position none = { NULL, 0 };
+    return none; // Not found
+}
+
+void UnrolledList::traverse(const std::string& msg)
+{
+    cout << msg << endl;
+    cout << "HEAD ==> ";
+    // Iterate the nodes from start to end
+    for (Node* node = head ; node != NULL ; node = node->next) {
+        cout << "[";
+        for (int i=0; i < node->count; i++) {
+            cout << " " << node->elements[i];
+        }
+        cout << " ] ==> ";
+    }
+    cout << "NULL" << endl << endl;
+}
+
+// Node of the plain singly linked list, used for comparison
+struct ListNode
+{
+    int element;
+    ListNode* next;
+};
+
+// Compare traversal and search against a plain singly linked list
+void benchmark(int size, int searches)
+{
+    // Build both lists with the same elements 0 .. size-1
+    ListNode* list = NULL;
+    for (int i=size-1; i >= 0; i--) {
+        ListNode* node = new ListNode();
+        node->element = i;
+        node->next = list;
+        list = node;
+    }
+    UnrolledList unrolled;
+    Position pos = unrolled.insert_front(0);
+    for (int i=1; i < size; i++) {
+        pos = unrolled.insert_after(pos, i);
+    }
+
+    // Traversal: sum all the elements
+    auto start = chrono::steady_clock::now();
+    long long sum = 0;
+    for (ListNode* node = list; node != NULL; node = node->next) {
+        sum += node->element;
+    }
+    double list_traverse = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (Node* node = unrolled.head; node != NULL; node = node->next) {
+        for (int i=0; i < node->count; i++) {
+            sum -= node->elements[i];
+        }
+    }
+    double unrolled_traverse = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Search: look up keys spread over the whole list
+    start = chrono::steady_clock::now();
+    long long found = 0;
+    for (int s=0; s < searches; s++) {
+        int key = (int)((long long)size * (s + 1) / (searches + 1));
+        for (ListNode* node = list; node != NULL; node = node->next) {
+            if (node->element == key) {
+                found++;
+                break;
+            }
+        }
+    }
+    double list_search = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int s=0; s < searches; s++) {
+        int key = (int)((long long)size * (s + 1) / (searches + 1));
+        if (unrolled.search(key).node != NULL) {
+            found--;
+        }
+    }
+    double unrolled_search = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "Benchmark with " << size << " elements (checksums " << sum << ", " << found << ")" << endl;
+    cout << "  traverse: List " << list_traverse << " ms, UnrolledList " << unrolled_traverse << " ms" << endl;
+    cout << "  " << searches << " searches: List " << list_search << " ms, UnrolledList " << unrolled_search << " ms" << endl;
+
+    while (list != NULL) {
+        ListNode* target = list;
+        list = list->next;
+        delete target;
+    }
+}
+
+int main()
+{
+    // Create an unrolled linked list
+    UnrolledList list;
+    list.traverse("initial list");
+
+    // Insert elements, filling more than one node
+    Position pos = list.insert_front(10);
+    for (int i=2; i <= 16; i++) {
+        pos = list.insert_after(pos, i * 10);
+    }
+    list.traverse("insert_front(10) and insert_after 20 .. 160");
+
+    list.insert_front(5);
+    list.traverse("insert_front(5)");
+
+    // Search an element
+    Position pos_30 = list.search(30);
+    cout << "search(30) matches element " << pos_30.node->elements[pos_30.index] << endl << endl;
+
+    list.insert_after(pos_30, 35);
+    list.traverse("insert_after(pos_30, 35)");
+
+    // Delete elements
+    list.delete_front();
+    list.traverse("delete_front()");
+
+    pos_30 = list.search(30);
+    list.delete_after(pos_30);
+    list.traverse("delete_after(pos_30)");
+
+    for (int i=16; i >= 8; i--) {
+        list.remove(i * 10);
+    }
+    list.traverse("remove(160) .. remove(80)");
+
+    benchmark(1000000, 100);
+}
@@ -0,0 +1,386 @@
+/**
+ * C++ example to demonstrate the XOR Linked List
+ *
+ * A doubly linked list normally stores a prev and a next pointer in every
+ * node. The XOR linked list stores a single link, prev XOR next. Walking
+ * from either end, the neighbour we came from is known, so XOR-ing it with
+ * the link gives the neighbour on the other side. The nodes live in an
+ * IndexPool and the links are 32-bit indices, so a node holding an int
+ * takes 8 bytes instead of the 24 bytes of a pointer based doubly node.
+ *
+ * The price is that a node alone cannot be navigated: every position is
+ * a cursor made of the node and its predecessor.
+ *
+ * Compile with: g++ -std=c++17 -O2 xor_linked_list.cpp
+ */
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include "index_pool.h"
+using namespace std;
+
+// Linked list node representation
+struct Node
+{
+    int element;
+    uint32_t link; // Index of the previous node XOR index of the next node
+};
+
+// Position in the list
+// A cursor is invalidated when the node before or at it is inserted or deleted
+// through another cursor.
+struct Cursor
+{
+    uint32_t prev; // Index of the previous node, NIL at the front
+    uint32_t curr; // Index of the current node, NIL past either end
+};
+
+/**
+ * XOR linked list implementation
+ */
+class XorList
+{
+    // Node storage
+    IndexPool<Node> nodes;
+
+    // First and last node of the list
+    uint32_t head;
+    uint32_t tail;
+
+public:
+    // Index which refers to no node
+    static const uint32_t NIL = IndexPool<Node>::NIL;
+
+    // Constructor
+    XorList() : head(NIL), tail(NIL) {}
+
+    // Returns a cursor at the first node
+    Cursor front() const { Cursor c = { NIL, head }; return c; }
+
+    // Returns a cursor at the last node
+    Cursor back() const { Cursor c = { tail == NIL ? NIL : nodes[tail].link, tail }; return c; }
+
+    // Move the cursor to the following node
+    void next(Cursor& c) const;
+
+    // Move the cursor to the preceding node
+    void prev(Cursor& c) const;
+
+    // Returns the element at the cursor
+    int& element(Cursor c) { return nodes[c.curr].element; }
+
+    // Insert an element in front of the list
+    // Returns the cursor at the new node
+    Cursor insert_front(int element);
+
+    // Insert an element at the end of the list
+    // Returns the cursor at the new node
+    Cursor insert_back(int element);
+
+    // Insert an element before the cursor, which then moves past the new node
+    // Returns the cursor at the new node
+    Cursor insert_before(Cursor& c, int element);
+
+    // Insert an element after the cursor
+    // Returns the cursor at the new node
+    Cursor insert_after(Cursor c, int element);
+
+    // Delete the front element
+    // Returns the cursor at the new front
+    Cursor delete_front();
+
+    // Delete the element from end of the list
+    // Returns the cursor at the new end
+    Cursor delete_back();
+
+    // Delete the element at the cursor
+    // Returns the cursor at the following node
+    Cursor delete_at(Cursor c);
+
+    // Search an element from the list
+    // Returns the cursor at the matching node if found, at NIL otherwise.
+    Cursor search(int element) const;
+
+    // Returns the number of elements
+    uint32_t size() const { return nodes.size(); }
+
+    // Returns the bytes of node storage
+    size_t memory() const { return nodes.memory(); }
+
+    // Print the list from front to end
+    void print(const std::string& msg) const;
+
+    // Print the list from end to front
+    void print_reverse(const std::string& msg) const;
+};
+
+void XorList::next(Cursor& c) const
+{
+    // The node after curr is its link without the node before it
+    uint32_t following = (c.curr == NIL) ? NIL : nodes[c.curr].link ^ c.prev;
+    c.prev = c.curr;
+    c.curr = following;
+}
+
+void XorList::prev(Cursor& c) const
+{
+    // The node before prev is its link without the node after it
+    uint32_t preceding = (c.prev == NIL) ? NIL : nodes[c.prev].link ^ c.curr;
+    c.curr = c.prev;
+    c.prev = preceding;
+}
+
+Cursor XorList::insert_front(int element)
+{
+    Cursor c = front();
+    return insert_before(c, element);
+}
+
+Cursor XorList::insert_back(int element)
+{
+    // Step 1. Check if the list is empty. If true, insert the first node.
+    if (tail == NIL) {
+        return insert_front(element);
+    }
+
+    // Step 2. Otherwise insert after the last node
+    return insert_after(back(), element);
+}
+
+Cursor XorList::insert_before(Cursor& c, int element)
+{
+    // Step 1. Allocate the new node between prev and curr
+    uint32_t new_node = nodes.allocate();
+    nodes[new_node].element = element;
+    nodes[new_node].link = c.prev ^ c.curr;
+
+    // Step 2. Replace curr by the new node in the link of prev
+    if (c.prev == NIL) {
+        head = new_node;
+    } else {
+        nodes[c.prev].link ^= c.curr ^ new_node;
+    }
+
+    // Step 3. Replace prev by the new node in the link of curr
+    if (c.curr == NIL) {
+        tail = new_node;
+    } else {
+        nodes[c.curr].link ^= c.prev ^ new_node;
+    }
+
+    Cursor inserted = { c.prev, new_node };
+    c.prev = new_node;
+    return inserted;
+}
+
+Cursor XorList::insert_after(Cursor c, int element)
+{
+    // Inserting after curr is inserting before the node following it
+    next(c);
+    return insert_before(c, element);
+}
+
+Cursor XorList::delete_front()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (head == NIL) {
+        return front();
+    }
+
+    // Step 2. Delete the first node
+    return delete_at(front());
+}
+
+Cursor XorList::delete_back()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (tail == NIL) {
+        return back();
+    }
+
+    // Step 2. Delete the last node and step back to the new end
+    Cursor c = delete_at(back());
+    prev(c);
+    return c;
+}
+
+Cursor XorList::delete_at(Cursor c)
+{
+    // Step 1. Find the node following the target
+    uint32_t target = c.curr;
+    uint32_t following = nodes[target].link ^ c.prev;
+
+    // Step 2. Replace the target by the following node in the link of prev
+    if (c.prev == NIL) {
+        head = following;
+    } else {
+        nodes[c.prev].link ^= target ^ following;
+    }
+
+    // Step 3. Replace the target by prev in the link of the following node
+    if (following == NIL) {
+        tail = c.prev;
+    } else {
+        nodes[following].link ^= target ^ c.prev;
+    }
+
+    // Step 4. Release the target node
+    nodes.deallocate(target);
+
+    Cursor next_cursor = { c.prev, following };
+    return next_cursor;
+}
+
+Cursor XorList::search(int element) const
+{
+    // Iterate the list from start to end
+    Cursor c = front();
+    while (c.curr != NIL && nodes[c.curr].element != element) {
+        next(c);
+    }
+    return c;
+}
+
+void XorList::print(const std::string& msg) const
+{
+    cout << msg << endl;
+    cout << "HEAD --> ";
+    // Iterate the linked list from start to end
+    for (Cursor c = front(); c.curr != NIL; next(c)) {
+        cout << nodes[c.curr].element;
+        cout << ((c.curr == tail)? " --> " : " <==> ");
+    }
+    cout << "NULL" << endl << endl;
+}
+
+void XorList::print_reverse(const std::string& msg) const
+{
+    cout << msg << endl;
+    cout << "TAIL --> ";
+    // Iterate the linked list from end to start
+    for (Cursor c = back(); c.curr != NIL; prev(c)) {
+        cout << nodes[c.curr].element;
+        cout << ((c.curr == head)? " --> " : " <==> ");
+    }
+    cout << "NULL" << endl << endl;
+}
+
+// Node of the pointer based doubly linked list, used for comparison
+struct PointerNode
+{
+    int element;
+    PointerNode* prev;
+    PointerNode* next;
+};
+
+// Compare memory, build, traversal and delete against a pointer based doubly list
+void benchmark(int size)
+{
+    // Build: append 0 .. size-1 to both lists
+    auto start = chrono::steady_clock::now();
+    PointerNode* head = NULL;
+    PointerNode* tail = NULL;
+    for (int i=0; i < size; i++) {
+        PointerNode* node = new PointerNode{ i, tail, NULL };
+        if (tail == NULL) {
+            head = node;
+        } else {
+            tail->next = node;
+        }
+        tail = node;
+    }
+    double pointer_build = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    XorList list;
+    for (int i=0; i < size; i++) {
+        list.insert_back(i);
+    }
+    double xor_build = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Traversal: sum all the elements forward and backward
+    long long sum = 0;
+    start = chrono::steady_clock::now();
+    for (PointerNode* node = head; node != NULL; node = node->next) {
+        sum += node->element;
+    }
+    for (PointerNode* node = tail; node != NULL; node = node->prev) {
+        sum += node->element;
+    }
+    double pointer_traverse = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (Cursor c = list.front(); c.curr != XorList::NIL; list.next(c)) {
+        sum -= list.element(c);
+    }
+    for (Cursor c = list.back(); c.curr != XorList::NIL; list.prev(c)) {
+        sum -= list.element(c);
+    }
+    double xor_traverse = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Delete: empty both lists from the front
+    start = chrono::steady_clock::now();
+    while (head != NULL) {
+        PointerNode* target = head;
+        head = head->next;
+        delete target;
+    }
+    double pointer_delete = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    size_t xor_memory = list.memory();
+    start = chrono::steady_clock::now();
+    while (list.size() > 0) {
+        list.delete_front();
+    }
+    double xor_delete = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "Benchmark with " << size << " elements (checksum " << sum << ")" << endl;
+    cout << "  node size: PointerNode " << sizeof(PointerNode) << " bytes + malloc header, XorList "
+         << sizeof(Node) << " bytes (" << xor_memory / size << " bytes/element with vector slack)" << endl;
+    cout << "  insert_back: pointer list " << pointer_build << " ms, XorList " << xor_build << " ms" << endl;
+    cout << "  traverse both ways: pointer list " << pointer_traverse << " ms, XorList " << xor_traverse << " ms" << endl;
+    cout << "  delete_front: pointer list " << pointer_delete << " ms, XorList " << xor_delete << " ms" << endl;
+}
+
+int main()
+{
+    // Create a XOR linked list
+    XorList list;
+    list.print("initial list");
+
+    // Insert elements
+    list.insert_front(20);
+    list.print("insert_front(20)");
+
+    list.insert_back(50);
+    list.print("insert_back(50)");
+
+    list.insert_front(10);
+    list.print("insert_front(10)");
+
+    // Insert around a cursor
+    Cursor pos_20 = list.search(20);
+    list.insert_after(pos_20, 30);
+    list.print("insert_after(pos_20, 30)");
+
+    Cursor pos_50 = list.search(50);
+    list.insert_before(pos_50, 40);
+    list.print("insert_before(pos_50, 40)");
+
+    // Traverse both ways
+    list.print_reverse("print_reverse()");
+
+    // Delete elements
+    list.delete_front();
+    list.print("delete_front()");
+
+    list.delete_back();
+    list.print("delete_back()");
+
+    Cursor pos_30 = list.search(30);
+    list.delete_at(pos_30);
+    list.print("delete_at(pos_30)");
+    list.print_reverse("print_reverse()");
+
+    benchmark(1000000);
+}
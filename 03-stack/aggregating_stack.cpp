@@ -0,0 +1,327 @@
+/**
+ * C++ example to demonstrate an aggregating Stack and Queue
+ *
+ * Every entry of the stack stores its element together with the aggregate
+ * of all the elements up to it, so the aggregate of the whole stack (its
+ * sum, min, max or gcd) is read from the top entry in O(1), and stays
+ * right after a pop since the entries below are unchanged.
+ *
+ * A queue made of two such stacks gets the same property: elements are
+ * pushed on the back stack and popped from the front stack, and when the
+ * front stack is empty the back stack is flipped onto it. Each element is
+ * moved once, so enqueue and dequeue are O(1) amortized, and the aggregate
+ * of the queue combines the aggregates of the two stacks. Used as a
+ * sliding window, this gives the window's aggregate in O(1) amortized per
+ * new element instead of rescanning the window.
+ *
+ * The aggregate may be any associative operation with an identity (a
+ * monoid); it does not need to be commutative, since the front stack
+ * combines its elements in queue order.
+ *
+ * Compile with: g++ -std=c++17 -O2 aggregating_stack.cpp
+ */
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * Monoids: an identity and an associative combine
+ */
+struct Sum
+{
+    static long long identity() { return 0; }
+    static long long combine(long long a, long long b) { return a + b; }
+};
+
+struct Min
+{
+    static long long identity() { return LLONG_MAX; }
+    static long long combine(long long a, long long b) { return a < b ? a : b; }
+};
+
+struct Max
+{
+    static long long identity() { return LLONG_MIN; }
+    static long long combine(long long a, long long b) { return a > b ? a : b; }
+};
+
+struct Gcd
+{
+    static long long identity() { return 0; }
+    static long long combine(long long a, long long b)
+    {
+        while (b != 0) {
+            long long r = a % b;
+            a = b;
+            b = r;
+        }
+        return a < 0 ? -a : a;
+    }
+};
+
+/**
+ * Aggregating Stack implementation using Array
+ * M is the monoid. The aggregate combines the elements from the bottom to
+ * the top, or from the top to the bottom if TOP_FIRST is set.
+ */
+template<class M, bool TOP_FIRST = false>
+class AggregatingStack
+{
+    /**
+     * Stack Entry Representation
+     */
+    struct Entry
+    {
+        long long element;
+        long long aggregate; // Aggregate of this element and the ones below
+    };
+
+    // Stack entries, the top at the back
+    std::vector<Entry> stack;
+
+public:
+    // Return true if the Stack is empty, false otherwise.
+    bool isEmpty() const { return stack.empty(); }
+
+    // Returns the number of elements
+    size_t size() const { return stack.size(); }
+
+    // Returns the top element without deleting
+    // Throws runtime_error if the stack is empty
+    long long peek() const
+    {
+        if (isEmpty()) {
+            throw std::runtime_error("stack underflow");
+        }
+        return stack.back().element;
+    }
+
+    // Returns the aggregate of all the elements, the identity if empty
+    long long aggregate() const { return isEmpty() ? M::identity() : stack.back().aggregate; }
+
+    // Push the new element to Stack
+    void push(long long element)
+    {
+        long long below = aggregate();
+        stack.push_back({ element, TOP_FIRST ? M::combine(element, below) : M::combine(below, element) });
+    }
+
+    // Pop the element from Stack
+    // Throws runtime_error if the stack is empty
+    long long pop()
+    {
+        long long element = peek();
+        stack.pop_back();
+        return element;
+    }
+
+    // Print the Stack
+    void print(const std::string& msg) const
+    {
+        cout << msg << endl;
+        if (isEmpty()) {
+            cout << "Stack is Empty" << endl;
+            return;
+        }
+
+        for (size_t i=stack.size(); i > 0; i--) {
+            cout << stack[i - 1].element << " (aggregate " << stack[i - 1].aggregate << ")"
+                 << (i == stack.size() ? " <-- top" : "") << endl;
+        }
+    }
+};
+
+/**
+ * Aggregating Queue implementation using two Stacks
+ */
+template<class M>
+class AggregatingQueue
+{
+    // Oldest elements, the front of the queue on top
+    AggregatingStack<M, true> front;
+
+    // Newest elements, the rear of the queue on top
+    AggregatingStack<M> back;
+
+public:
+    // Return true if the Queue is empty, false otherwise.
+    bool isEmpty() const { return front.isEmpty() && back.isEmpty(); }
+
+    // Returns the number of elements
+    size_t size() const { return front.size() + back.size(); }
+
+    // Returns the aggregate of all the elements from front to rear
+    long long aggregate() const { return M::combine(front.aggregate(), back.aggregate()); }
+
+    // Enqueue new element to Queue
+    void enqueue(long long element) { back.push(element); }
+
+    // Dequeue an element from Queue
+    // Throws runtime_error if the queue is empty
+    long long dequeue();
+};
+
+template<class M>
+long long AggregatingQueue<M>::dequeue()
+{
+    // Step 1. Return if the Queue is empty, proceed otherwise
+    if (isEmpty()) {
+        throw std::runtime_error("queue underflow");
+    }
+
+    // Step 2. If the front stack is empty, flip the back stack onto it so
+    // the oldest element ends on top
+    if (front.isEmpty()) {
+        while (!back.isEmpty()) {
+            front.push(back.pop());
+        }
+    }
+
+    // Step 3. Pop the oldest element
+    return front.pop();
+}
+
+/**
+ * Sliding Window aggregation using the Aggregating Queue
+ */
+template<class M>
+class SlidingWindow
+{
+    AggregatingQueue<M> window;
+    size_t width;
+
+public:
+    // Constructor, for a window of the given number of elements
+    SlidingWindow(size_t width) : width(width) {}
+
+    // Add a new element, dropping the oldest one once the window is full
+    // Returns the aggregate of the window
+    long long add(long long element)
+    {
+        window.enqueue(element);
+        if (window.size() > width) {
+            window.dequeue();
+        }
+        return window.aggregate();
+    }
+};
+
+// Compare the sliding window against rescanning the window per element
+// Returns a checksum of the sliding window aggregates
+template<class M>
+long long benchmark(const char* name, const std::vector<long long>& stream, size_t width)
+{
+    // Sliding window over the whole stream
+    long long checksum = 0;
+    auto start = chrono::steady_clock::now();
+    SlidingWindow<M> window(width);
+    for (size_t i=0; i < stream.size(); i++) {
+        checksum += window.add(stream[i]);
+    }
+    double window_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / stream.size();
+
+    // Rescanning, on enough full windows for a stable time. The results
+    // must match the sliding window's on the same positions.
+    size_t steps = 20000000 / width;
+    if (steps < 10) {
+        steps = 10;
+    }
+    SlidingWindow<M> check(width);
+    long long expected = 0;
+    for (size_t i=0; i < width + steps; i++) {
+        long long result = check.add(stream[i]);
+        if (i >= width) {
+            expected += result;
+        }
+    }
+    long long rescan = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i=width; i < width + steps; i++) {
+        long long result = M::identity();
+        for (size_t j=i+1-width; j <= i; j++) {
+            result = M::combine(result, stream[j]);
+        }
+        rescan += result;
+    }
+    double rescan_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / steps;
+
+    cout.width(4);
+    cout << name << " | ";
+    cout.width(8);
+    cout << width << " | ";
+    cout.width(15);
+    cout << window_ns << " | ";
+    cout.width(15);
+    cout << rescan_ns << (rescan == expected ? "" : "  MISMATCH") << endl;
+    return checksum;
+}
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Stack tracking the minimum
+    AggregatingStack<Min> stack;
+
+    // Push the elements (30, 10, 40 and 20)
+    stack.push(30);
+    stack.push(10);
+    stack.push(40);
+    stack.push(20);
+    stack.print("Min stack after pushing 30 10 40 and 20");
+
+    // Pop the elements from Stack, the minimum follows
+    stack.pop();
+    stack.pop();
+    cout << "Min after poping two elements is " << stack.aggregate() << endl;
+    stack.pop();
+    cout << "Min after poping three elements is " << stack.aggregate() << endl;
+
+    // Queue of the gcd of its elements
+    AggregatingQueue<Gcd> queue;
+    queue.enqueue(12);
+    queue.enqueue(18);
+    queue.enqueue(27);
+    cout << "gcd(12 18 27) = " << queue.aggregate() << endl;
+    queue.dequeue();
+    cout << "gcd(18 27) = " << queue.aggregate() << endl;
+    queue.dequeue();
+    queue.enqueue(45);
+    cout << "gcd(27 45) = " << queue.aggregate() << endl;
+
+    // Sliding window maximum
+    SlidingWindow<Max> window(3);
+    long long values[] = { 5, 1, 3, 7, 2, 2, 1, 6 };
+    cout << "Max of the last 3 elements:";
+    for (long long value : values) {
+        cout << " " << window.add(value);
+    }
+    cout << endl;
+
+    // Dequeue past the rear
+    try {
+        queue.dequeue();
+        queue.dequeue();
+    } catch (const std::exception& e) {
+        cout << "Dequeue: exception received: " << e.what() << endl;
+    }
+
+    // Benchmark, 10M random elements
+    std::mt19937_64 random(42);
+    std::vector<long long> stream(10000000);
+    for (size_t i=0; i < stream.size(); i++) {
+        stream[i] = (long long)(random() % 1000000);
+    }
+    cout << endl << "  OP |   WINDOW | SLIDING NS/ELEM | RESCAN NS/ELEM" << endl;
+    cout << "-----+----------+-----------------+---------------" << endl;
+    long long checksum = 0;
+    for (size_t width=1000; width <= 1000000; width *= 10) {
+        checksum += benchmark<Max>("max", stream, width);
+        checksum += benchmark<Sum>("sum", stream, width);
+    }
+    cout << "(checksum " << checksum << ")" << endl;
+}
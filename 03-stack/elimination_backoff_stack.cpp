@@ -0,0 +1,501 @@
+/**
+ * C++ example to demonstrate an Elimination-Backoff Stack
+ *
+ * The lock-free stack of lock_free_stack.cpp makes every thread CAS the
+ * same top word, so under heavy contention most CAS fail and retry. Here
+ * a thread whose CAS fails backs off into an elimination array instead:
+ * a push and a pop meeting in the same slot hand the element over
+ * directly and never touch the top, which is correct because a push
+ * immediately followed by a pop leaves the stack unchanged.
+ *
+ * Each stack keeps a range, and threads pick slots among the first
+ * `range` ones. The range grows on a collision, a slot already busy or a
+ * partner taken by another thread (too many threads per slot), and
+ * shrinks when a thread waits in a slot and no partner comes (too few
+ * threads, so they should meet in fewer slots).
+ *
+ * Compile with: g++ -std=c++17 -O2 -pthread elimination_backoff_stack.cpp
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Index which refers to no node
+#define NIL 0
+
+// Number of checks a waiting thread makes before giving up a slot
+#define ELIMINATION_SPINS 256
+
+// Number of slots in the elimination array
+#define ELIMINATION_SLOTS 16
+
+// States of an elimination slot, kept in the high half of its word
+#define SLOT_EMPTY 0       // Free
+#define SLOT_PUSH 1        // A push waits with its element
+#define SLOT_POP 2         // A pop waits for an element
+#define SLOT_TAKEN 3       // A pop took the waiting push's element
+#define SLOT_GIVEN 4       // A push gave its element to the waiting pop
+
+/**
+ * Stack Node Representation
+ */
+struct Node
+{
+    int element;
+    std::atomic<uint32_t> next; // Index of the next node
+};
+
+/**
+ * Elimination array slot, one per cache line
+ */
+struct alignas(64) Slot
+{
+    std::atomic<uint64_t> word{ SLOT_EMPTY }; // State << 32 | element
+};
+
+/**
+ * Elimination-Backoff Stack implementation using Linked List
+ */
+class EliminationBackoffStack
+{
+    // Top of the stack: tag in the high half, node index in the low half
+    alignas(64) std::atomic<uint64_t> top;
+
+    // Top of the stack of recycled nodes, tagged the same way
+    alignas(64) std::atomic<uint64_t> free_top;
+
+    // Number of node indices handed out, index 0 is NIL
+    alignas(64) std::atomic<uint32_t> used;
+
+    // Nodes, allocated once
+    Node* nodes;
+    uint32_t capacity;
+
+    // Elimination array, NULL if elimination is disabled
+    Slot* slots;
+    int slot_count;
+
+    // Number of slots the threads pick from, adapted to the contention
+    alignas(64) std::atomic<int> elimination_range;
+
+public:
+    // Constructor, with room for capacity elements.
+    // With 0 slots, the stack is a plain Treiber stack.
+    EliminationBackoffStack(uint32_t capacity, int slot_count = ELIMINATION_SLOTS);
+
+    // Destructor
+    ~EliminationBackoffStack();
+
+    // Push the new element to Stack
+    // Throws runtime_error if the stack is full
+    void push(int element);
+
+    // Pop the element from Stack
+    // Returns true and sets the element on success, false if the stack is empty.
+    bool pop(int& element);
+
+    // Print the Stack, only while no other thread uses it
+    void print(const std::string& msg);
+
+private:
+    EliminationBackoffStack(const EliminationBackoffStack&);
+    EliminationBackoffStack& operator=(const EliminationBackoffStack&);
+
+    // Take a recycled or new node
+    // Throws runtime_error if the stack is full
+    uint32_t allocate_node();
+
+    // One CAS to link the node on top of a tagged stack
+    // Returns false if another thread changed the top meanwhile.
+    bool try_push_node(std::atomic<uint64_t>& head, uint32_t index);
+
+    // One CAS to unlink the top node of a tagged stack
+    // Returns false if another thread changed the top meanwhile, else
+    // true with the index of the node, NIL if the stack is empty.
+    bool try_pop_node(std::atomic<uint64_t>& head, uint32_t& index);
+
+    // Meet a pop in the elimination array and give it the element
+    // Returns true if a pop took the element.
+    bool eliminate_push(int element);
+
+    // Meet a push in the elimination array and take its element
+    // Returns true if an element was taken.
+    bool eliminate_pop(int& element);
+
+    // Pick a slot within the range
+    Slot& pick_slot();
+
+    // Widen the range after a collision, so the threads spread out
+    void grow_range();
+
+    // Narrow the range after a timeout, so the threads meet more often
+    void shrink_range();
+
+    // Helpers for tagged and slot words
+    static uint32_t index_of(uint64_t word) { return (uint32_t)word; }
+    static uint64_t tagged(uint64_t old_word, uint32_t index) { return ((old_word >> 32) + 1) << 32 | index; }
+    static uint64_t slot_word(uint64_t state, int element) { return state << 32 | (uint32_t)element; }
+    static uint64_t state_of(uint64_t word) { return word >> 32; }
+};
+
+// Random state of the thread
+static thread_local uint32_t random_state = 0;
+
+EliminationBackoffStack::EliminationBackoffStack(uint32_t capacity, int slot_count)
+    : top(NIL), free_top(NIL), used(1), capacity(capacity), slot_count(slot_count), elimination_range(1)
+{
+    nodes = new Node[capacity + 1]();
+    slots = slot_count > 0 ? new Slot[slot_count] : NULL;
+}
+
+EliminationBackoffStack::~EliminationBackoffStack()
+{
+    delete[] nodes;
+    delete[] slots;
+}
+
+uint32_t EliminationBackoffStack::allocate_node()
+{
+    // Step 1. Reuse a recycled node if any
+    uint32_t index;
+    while (!try_pop_node(free_top, index)) {
+    }
+    if (index != NIL) {
+        return index;
+    }
+
+    // Step 2. Otherwise take the next unused node
+    index = used.fetch_add(1);
+    if (index > capacity) {
+        used.fetch_sub(1);
+        throw std::runtime_error("stack overflow");
+    }
+    return index;
+}
+
+bool EliminationBackoffStack::try_push_node(std::atomic<uint64_t>& head, uint32_t index)
+{
+    uint64_t old_top = head.load(std::memory_order_relaxed);
+    nodes[index].next.store(index_of(old_top), std::memory_order_relaxed);
+    return head.compare_exchange_strong(old_top, tagged(old_top, index),
+                                        std::memory_order_release, std::memory_order_relaxed);
+}
+
+bool EliminationBackoffStack::try_pop_node(std::atomic<uint64_t>& head, uint32_t& index)
+{
+    // The node may be popped and reused by another thread while we read its
+    // next index, but then the tag of the top has changed and the CAS fails.
+    uint64_t old_top = head.load(std::memory_order_acquire);
+    index = index_of(old_top);
+    if (index == NIL) {
+        return true;
+    }
+    uint32_t next = nodes[index].next.load(std::memory_order_relaxed);
+    return head.compare_exchange_strong(old_top, tagged(old_top, next),
+                                        std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+Slot& EliminationBackoffStack::pick_slot()
+{
+    // xorshift, seeded from the address of the thread's state
+    if (random_state == 0) {
+        random_state = (uint32_t)(uintptr_t)&random_state | 1;
+    }
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    int range = elimination_range.load(std::memory_order_relaxed);
+    return slots[random_state % range];
+}
+
+// The range is only a hint: a lost update between threads does no harm
+void EliminationBackoffStack::grow_range()
+{
+    int range = elimination_range.load(std::memory_order_relaxed);
+    if (range < slot_count) {
+        elimination_range.store(range + 1, std::memory_order_relaxed);
+    }
+}
+
+void EliminationBackoffStack::shrink_range()
+{
+    int range = elimination_range.load(std::memory_order_relaxed);
+    if (range > 1) {
+        elimination_range.store(range - 1, std::memory_order_relaxed);
+    }
+}
+
+bool EliminationBackoffStack::eliminate_push(int element)
+{
+    Slot& slot = pick_slot();
+    uint64_t word = slot.word.load(std::memory_order_acquire);
+
+    // Case 1. A pop is waiting: give it the element. Losing it to another
+    // push is a collision.
+    if (state_of(word) == SLOT_POP) {
+        bool given = slot.word.compare_exchange_strong(word, slot_word(SLOT_GIVEN, element),
+                                                       std::memory_order_release, std::memory_order_relaxed);
+        if (!given) {
+            grow_range();
+        }
+        return given;
+    }
+
+    // Case 2. Another thread uses the slot: a collision, give up
+    uint64_t offer = slot_word(SLOT_PUSH, element);
+    if (state_of(word) != SLOT_EMPTY ||
+        !slot.word.compare_exchange_strong(word, offer, std::memory_order_release, std::memory_order_relaxed)) {
+        grow_range();
+        return false;
+    }
+
+    // Case 3. The slot was free: wait there for a pop to take the element
+    for (int i=0; i < ELIMINATION_SPINS; i++) {
+        if (slot.word.load(std::memory_order_acquire) != offer) {
+            break;
+        }
+        if (i % 32 == 31) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Withdraw the offer. If that fails, a pop took the element, otherwise
+    // no pop came in time.
+    bool taken = !slot.word.compare_exchange_strong(offer, SLOT_EMPTY, std::memory_order_relaxed);
+    if (taken) {
+        slot.word.store(SLOT_EMPTY, std::memory_order_release);
+    } else {
+        shrink_range();
+    }
+    return taken;
+}
+
+bool EliminationBackoffStack::eliminate_pop(int& element)
+{
+    Slot& slot = pick_slot();
+    uint64_t word = slot.word.load(std::memory_order_acquire);
+
+    // Case 1. A push is waiting: take its element. Losing it to another
+    // pop is a collision.
+    if (state_of(word) == SLOT_PUSH) {
+        bool taken = slot.word.compare_exchange_strong(word, slot_word(SLOT_TAKEN, (int)word),
+                                                       std::memory_order_acquire, std::memory_order_relaxed);
+        if (taken) {
+            element = (int)word;
+        } else {
+            grow_range();
+        }
+        return taken;
+    }
+
+    // Case 2. Another thread uses the slot: a collision, give up
+    uint64_t request = slot_word(SLOT_POP, 0);
+    if (state_of(word) != SLOT_EMPTY ||
+        !slot.word.compare_exchange_strong(word, request, std::memory_order_relaxed)) {
+        grow_range();
+        return false;
+    }
+
+    // Case 3. The slot was free: wait there for a push to give an element
+    for (int i=0; i < ELIMINATION_SPINS; i++) {
+        if (slot.word.load(std::memory_order_relaxed) != request) {
+            break;
+        }
+        if (i % 32 == 31) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Withdraw the request. If that fails, a push gave its element,
+    // otherwise no push came in time.
+    bool given = !slot.word.compare_exchange_strong(request, SLOT_EMPTY,
+                                                    std::memory_order_acquire, std::memory_order_acquire);
+    if (given) {
+        element = (int)request;
+        slot.word.store(SLOT_EMPTY, std::memory_order_release);
+    } else {
+        shrink_range();
+    }
+    return given;
+}
+
+void EliminationBackoffStack::push(int element)
+{
+    // Step 1. Take a node and store the element, the node is ours alone
+    uint32_t index = allocate_node();
+    nodes[index].element = element;
+
+    // Step 2. Try the top, then the elimination array, until one succeeds
+    while (!try_push_node(top, index)) {
+        if (slots != NULL && eliminate_push(element)) {
+            // A pop took the element, so the node is not needed
+            while (!try_push_node(free_top, index)) {
+            }
+            return;
+        }
+    }
+}
+
+bool EliminationBackoffStack::pop(int& element)
+{
+    // Step 1. Try the top, then the elimination array, until one succeeds
+    uint32_t index;
+    while (!try_pop_node(top, index)) {
+        if (slots != NULL && eliminate_pop(element)) {
+            return true;
+        }
+    }
+
+    // Step 2. Return if the Stack is empty
+    if (index == NIL) {
+        return false;
+    }
+
+    // Step 3. Read the element and recycle the node
+    element = nodes[index].element;
+    while (!try_push_node(free_top, index)) {
+    }
+    return true;
+}
+
+void EliminationBackoffStack::print(const std::string& msg)
+{
+    cout << msg << endl;
+    uint32_t index = index_of(top.load());
+    if (index == NIL) {
+        cout << "Stack is Empty" << endl;
+        return;
+    }
+
+    cout << nodes[index].element << " <-- top" << endl;
+    for (index = nodes[index].next.load(); index != NIL; index = nodes[index].next.load()) {
+        cout << nodes[index].element << endl;
+    }
+}
+
+// Node of the Stack using Linked List, used for comparison
+struct PlainNode
+{
+    int element;
+    PlainNode* next;
+};
+
+// Stack using Linked List behind one mutex, used for comparison
+class MutexStack
+{
+    std::mutex lock;
+    PlainNode* top = NULL;
+
+public:
+    ~MutexStack()
+    {
+        int element;
+        while (pop(element)) {
+        }
+    }
+
+    void push(int element)
+    {
+        PlainNode* node = new PlainNode{ element, NULL };
+        std::lock_guard<std::mutex> guard(lock);
+        node->next = top;
+        top = node;
+    }
+
+    bool pop(int& element)
+    {
+        PlainNode* target;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (top == NULL) {
+                return false;
+            }
+            target = top;
+            top = target->next;
+        }
+        element = target->element;
+        delete target;
+        return true;
+    }
+};
+
+// Half of the threads push and half pop, all on the same stack
+// Returns the throughput in operations per second
+template<class StackType>
+long long run(StackType& stack, int threads, int ops)
+{
+    std::atomic<long long> checksum(0);
+    auto worker = [&](int t) {
+        long long sum = 0;
+        int element;
+        for (int i=0; i < ops / threads; i++) {
+            if (t % 2 == 0) {
+                stack.push(i);
+            } else if (stack.pop(element)) {
+                sum += element;
+            }
+        }
+        checksum += sum;
+    };
+
+    auto start = chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t=0; t < threads; t++) {
+        pool.push_back(std::thread(worker, t));
+    }
+    for (size_t t=0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return (long long)(ops / ms * 1000);
+}
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Stack
+    EliminationBackoffStack stack(100);
+
+    // Push the elements (10, 20, 30 and 40)
+    stack.push(10);
+    stack.push(20);
+    stack.push(30);
+    stack.push(40);
+    stack.print("Stack after inserting 10 20 30 and 40");
+
+    // Pop the elements from Stack
+    int element;
+    stack.pop(element);
+    cout << "Pop element returned " << element << endl;
+    stack.pop(element);
+    cout << "Pop element returned " << element << endl;
+    stack.print("Stack after poping two elements");
+
+    // Contention benchmark, pushers and poppers in equal numbers
+    const int ops = 4000000;
+    cout << endl << " THREADS | ELIMINATION OPS/SEC | TREIBER OPS/SEC | MUTEX OPS/SEC" << endl;
+    cout << "---------+---------------------+-----------------+--------------" << endl;
+    for (int threads=2; threads <= 64; threads *= 2) {
+        EliminationBackoffStack elimination(ops);
+        EliminationBackoffStack treiber(ops, 0);
+        MutexStack mutex;
+        long long elimination_rate = run(elimination, threads, ops);
+        long long treiber_rate = run(treiber, threads, ops);
+        long long mutex_rate = run(mutex, threads, ops);
+        cout.width(8);
+        cout << threads << " | ";
+        cout.width(19);
+        cout << elimination_rate << " | ";
+        cout.width(15);
+        cout << treiber_rate << " | ";
+        cout.width(13);
+        cout << mutex_rate << endl;
+    }
+}
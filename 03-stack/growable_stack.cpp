@@ -0,0 +1,386 @@
+/**
+ * C++ example to demonstrate a growable Stack using a dynamic Array
+ *
+ * The stack of stack_using_array.cpp has a fixed capacity. This one
+ * doubles its array when it is full, so a push is O(1) amortized, and
+ * push_n()/pop_n() move whole spans with one memcpy. The first INLINE
+ * elements live inside the stack object itself, so a shallow stack on
+ * the call stack never touches the heap.
+ *
+ * Compile with: g++ -std=c++17 -O2 growable_stack.cpp
+ */
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <stack>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+/**
+ * Growable Stack implementation using Array
+ * T must be trivially copyable since the elements are moved with memcpy.
+ * INLINE is the number of elements stored without heap allocation.
+ */
+template<class T, size_t INLINE = 0>
+class GrowableStack
+{
+    static_assert(std::is_trivially_copyable<T>::value, "elements must be trivially copyable");
+
+    // Stack data, either inline_data or a heap array
+    T* stack;
+
+    // Number of elements
+    size_t count;
+
+    // Number of elements the array can hold
+    size_t capacity;
+
+    // Inline storage, at least one element so the array is never empty
+    T inline_data[INLINE > 0 ? INLINE : 1];
+
+public:
+    // Constructor
+    GrowableStack() : stack(INLINE > 0 ? inline_data : NULL), count(0), capacity(INLINE) {}
+
+    // Destructor
+    ~GrowableStack() { release(); }
+
+    // Return true if the Stack is empty, false otherwise.
+    bool isEmpty() const { return count == 0; }
+
+    // Returns the number of elements
+    size_t size() const { return count; }
+
+    // Make room for at least the given number of elements
+    void reserve(size_t min_capacity);
+
+    // Returns the top element without deleting
+    // Throws runtime_error if the stack is empty
+    T peek() const;
+
+    // Push the new element to Stack, growing the array if full
+    void push(const T& element);
+
+    // Push n elements, values[n-1] ending on top
+    // The values may be elements of this stack.
+    void push_n(const T* values, size_t n);
+
+    // Pop the element from Stack
+    // Throws runtime_error if the stack is empty
+    T pop();
+
+    // Pop the top n elements into out, the previous top ending in out[n-1]
+    // Throws runtime_error if the stack holds fewer than n elements
+    void pop_n(T* out, size_t n);
+
+    // Print the Stack
+    void print(const std::string& msg) const;
+
+private:
+    GrowableStack(const GrowableStack&);
+    GrowableStack& operator=(const GrowableStack&);
+
+    // Move the elements to a larger array, doubling the capacity at least
+    void grow(size_t min_capacity);
+
+    // Release the heap array if any
+    void release()
+    {
+        if (stack != inline_data) {
+            ::operator delete(stack);
+        }
+    }
+};
+
+template<class T, size_t INLINE>
+void GrowableStack<T, INLINE>::grow(size_t min_capacity)
+{
+    // Step 1. Double the capacity, or more if requested
+    size_t new_capacity = capacity < 8 ? 8 : capacity * 2;
+    if (new_capacity < min_capacity) {
+        new_capacity = min_capacity;
+    }
+
+    // Step 2. Copy the elements to the new array and release the old one
+    T* new_stack = static_cast<T*>(::operator new(new_capacity * sizeof(T)));
+    if (count > 0) {
+        std::memcpy(new_stack, stack, count * sizeof(T));
+    }
+    release();
+    stack = new_stack;
+    capacity = new_capacity;
+}
+
+template<class T, size_t INLINE>
+void GrowableStack<T, INLINE>::reserve(size_t min_capacity)
+{
+    if (min_capacity > capacity) {
+        grow(min_capacity);
+    }
+}
+
+template<class T, size_t INLINE>
+T GrowableStack<T, INLINE>::peek() const
+{
+    if (isEmpty()) {
+        throw std::runtime_error("stack underflow");
+    }
+    return stack[count - 1];
+}
+
+template<class T, size_t INLINE>
+void GrowableStack<T, INLINE>::push(const T& element)
+{
+    // Step 1. Grow the array if the Stack is full
+    if (count == capacity) {
+        T copy = element; // The element may live in the array being released
+        grow(count + 1);
+        stack[count++] = copy;
+        return;
+    }
+
+    // Step 2. Insert the new element on Top
+    stack[count++] = element;
+}
+
+template<class T, size_t INLINE>
+void GrowableStack<T, INLINE>::push_n(const T* values, size_t n)
+{
+    // Step 1. Make room for all the elements at once. The values may live
+    // in the array being released: then push a copy of them.
+    if (count + n > capacity) {
+        if (std::less_equal<const T*>()(stack, values) && std::less<const T*>()(values, stack + capacity)) {
+            std::vector<T> copy(values, values + n);
+            grow(count + n);
+            push_n(copy.data(), n);
+            return;
+        }
+        grow(count + n);
+    }
+
+    // Step 2. Copy them on Top in one block
+    if (n > 0) {
+        std::memcpy(stack + count, values, n * sizeof(T));
+    }
+    count += n;
+}
+
+template<class T, size_t INLINE>
+T GrowableStack<T, INLINE>::pop()
+{
+    // Step 1. Return if the Stack is empty, proceed otherwise
+    if (isEmpty()) {
+        throw std::runtime_error("stack underflow");
+    }
+
+    // Step 2. Retrieve the element on Top and move Top down
+    return stack[--count];
+}
+
+template<class T, size_t INLINE>
+void GrowableStack<T, INLINE>::pop_n(T* out, size_t n)
+{
+    // Step 1. Check if there are enough elements
+    if (n > count) {
+        throw std::runtime_error("stack underflow");
+    }
+
+    // Step 2. Copy the top block out and move Top down
+    count -= n;
+    if (n > 0) {
+        std::memcpy(out, stack + count, n * sizeof(T));
+    }
+}
+
+template<class T, size_t INLINE>
+void GrowableStack<T, INLINE>::print(const std::string& msg) const
+{
+    cout << msg << endl;
+    if (isEmpty()) {
+        cout << "Stack is Empty" << endl;
+        return;
+    }
+
+    cout << stack[count - 1] << " <-- top" << endl;
+    for (size_t i=count-1; i > 0; i--) {
+        cout << stack[i - 1] << endl;
+    }
+    cout << "(" << count << " of " << capacity << (stack == inline_data ? " inline)" : " on heap)") << endl;
+}
+
+// Node of the Stack using Linked List, used for comparison
+struct Node
+{
+    int element;
+    Node* next;
+};
+
+// Stack using Linked List, as in stack_using_linked_list.cpp
+struct LinkedStack
+{
+    Node* top = NULL;
+
+    ~LinkedStack()
+    {
+        while (top != NULL) {
+            pop();
+        }
+    }
+
+    void push(int element) { top = new Node{ element, top }; }
+
+    int pop()
+    {
+        Node* target = top;
+        int element = target->element;
+        top = target->next;
+        delete target;
+        return element;
+    }
+};
+
+// Compare deep and shallow stacks against std::stack and the linked stack
+void benchmark(int size, int shallow_rounds)
+{
+    long long sum = 0;
+
+    // Deep stack: 3 rounds of pushing and popping size elements one by one.
+    // The first round grows the array, the next ones reuse it.
+    auto start = chrono::steady_clock::now();
+    {
+        GrowableStack<int> stack;
+        for (int round=0; round < 3; round++) {
+            for (int i=0; i < size; i++) {
+                stack.push(i);
+            }
+            for (int i=0; i < size; i++) {
+                sum += stack.pop();
+            }
+        }
+    }
+    double growable_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Deep stack with batches of 64 elements through push_n() and pop_n()
+    std::vector<int> batch(64);
+    for (int i=0; i < 64; i++) {
+        batch[i] = i;
+    }
+    start = chrono::steady_clock::now();
+    {
+        GrowableStack<int> stack;
+        for (int round=0; round < 3; round++) {
+            for (int i=0; i < size; i += 64) {
+                stack.push_n(batch.data(), 64);
+            }
+            while (!stack.isEmpty()) {
+                stack.pop_n(batch.data(), 64);
+                sum -= batch[63];
+            }
+        }
+    }
+    double batch_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    {
+        std::stack<int, std::vector<int>> stack;
+        for (int round=0; round < 3; round++) {
+            for (int i=0; i < size; i++) {
+                stack.push(i);
+            }
+            for (int i=0; i < size; i++) {
+                sum -= stack.top();
+                stack.pop();
+            }
+        }
+    }
+    double std_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    {
+        LinkedStack stack;
+        for (int round=0; round < 3; round++) {
+            for (int i=0; i < size; i++) {
+                stack.push(i);
+            }
+            for (int i=0; i < size; i++) {
+                sum += stack.pop();
+            }
+        }
+    }
+    double linked_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "3 rounds of push and pop of " << size << " elements" << endl;
+    cout << "  GrowableStack " << growable_ms << " ms, push_n/pop_n by 64 " << batch_ms
+         << " ms, std::stack " << std_ms << " ms, linked stack " << linked_ms << " ms" << endl;
+
+    // Shallow stacks: a fresh stack holding up to 16 elements per round
+    start = chrono::steady_clock::now();
+    for (int r=0; r < shallow_rounds; r++) {
+        GrowableStack<int, 16> stack;
+        for (int i=0; i < 16; i++) {
+            stack.push(r + i);
+        }
+        while (!stack.isEmpty()) {
+            sum += stack.pop();
+        }
+    }
+    double inline_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int r=0; r < shallow_rounds; r++) {
+        std::stack<int, std::vector<int>> stack;
+        for (int i=0; i < 16; i++) {
+            stack.push(r + i);
+        }
+        while (!stack.empty()) {
+            sum -= stack.top();
+            stack.pop();
+        }
+    }
+    double std_shallow_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << shallow_rounds << " shallow stacks of 16 elements (checksum " << sum << ")" << endl;
+    cout << "  GrowableStack<int, 16> " << inline_ms << " ms, std::stack " << std_shallow_ms << " ms" << endl;
+}
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Stack with room for 4 elements inline
+    GrowableStack<int, 4> stack;
+
+    // Push the elements (10, 20, 30 and 40), which fit inline
+    stack.push(10);
+    stack.push(20);
+    stack.push(30);
+    stack.push(40);
+    stack.print("Stack after pushing 10 20 30 and 40");
+
+    // Pushing 50 moves the elements to the heap
+    stack.push(50);
+    stack.print("Stack after pushing 50");
+
+    // Push and pop spans
+    int values[] = { 60, 70, 80 };
+    stack.push_n(values, 3);
+    stack.print("Stack after push_n(60 70 80)");
+
+    int out[4];
+    stack.pop_n(out, 4);
+    cout << "pop_n(4) returned " << out[0] << " " << out[1] << " " << out[2] << " " << out[3] << endl;
+    stack.print("Stack after pop_n(4)");
+
+    // Pop past the bottom
+    try {
+        stack.pop_n(out, 5);
+    } catch (const std::exception& e) {
+        cout << "pop_n(5): exception received: " << e.what() << endl;
+    }
+
+    benchmark(10000000, 1000000);
+}
@@ -0,0 +1,340 @@
+/**
+ * C++ example to demonstrate a lock-free Stack (Treiber stack)
+ *
+ * The stack of stack_using_linked_list.cpp made safe for many threads
+ * without locks: push and pop swing the top with a compare-and-swap.
+ *
+ * The classic hazard of this stack is ABA: a thread reads top = A and
+ * next = B, other threads pop A and B and push A back, and the CAS from
+ * A to B succeeds although B is gone. Here the top is a 64-bit word made
+ * of a 32-bit node index and a 32-bit tag bumped by every change, so the
+ * stale CAS fails. The nodes live in chunks which are never freed while
+ * the stack exists, and popped nodes are recycled through a second tagged
+ * stack, so a steady stream of pushes and pops never allocates, and a
+ * thread reading a node just popped by another still reads valid memory.
+ *
+ * Compile with: g++ -std=c++17 -O2 -pthread lock_free_stack.cpp
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Number of nodes per chunk, a power of two
+#define CHUNK_NODES 1024
+
+// Maximum number of chunks, bounding the stack to 4M nodes
+#define MAX_CHUNKS 4096
+
+// Index which refers to no node
+#define NIL 0
+
+/**
+ * Stack Node Representation
+ */
+struct Node
+{
+    int element;
+    std::atomic<uint32_t> next; // Index of the next node
+};
+
+/**
+ * Lock-free Stack implementation using Linked List
+ */
+class LockFreeStack
+{
+    // Top of the stack: tag in the high half, node index in the low half
+    alignas(64) std::atomic<uint64_t> top;
+
+    // Top of the stack of recycled nodes, tagged the same way
+    alignas(64) std::atomic<uint64_t> free_top;
+
+    // Number of node indices handed out, index 0 is NIL
+    alignas(64) std::atomic<uint32_t> used;
+
+    // Node chunks, allocated on demand under the lock
+    std::atomic<Node*> chunks[MAX_CHUNKS];
+    std::mutex chunk_lock;
+
+public:
+    // Constructor
+    LockFreeStack();
+
+    // Destructor releases every chunk
+    ~LockFreeStack();
+
+    // Push the new element to Stack
+    // Throws runtime_error if all the node indices are in use
+    void push(int element);
+
+    // Pop the element from Stack
+    // Returns true and sets the element on success, false if the stack is empty.
+    bool pop(int& element);
+
+    // Return true if the Stack is empty, false otherwise.
+    bool isEmpty() const { return index_of(top.load()) == NIL; }
+
+    // Print the Stack, only while no other thread uses it
+    void print(const std::string& msg);
+
+private:
+    // Returns the node of an index
+    Node* node_at(uint32_t index);
+
+    // Take a node from the recycled ones, or a new one
+    uint32_t allocate_node();
+
+    // Link the node on top of a tagged stack
+    void push_node(std::atomic<uint64_t>& head, uint32_t index);
+
+    // Unlink the top node of a tagged stack
+    // Returns the index of the node, NIL if the stack is empty.
+    uint32_t pop_node(std::atomic<uint64_t>& head);
+
+    // Helpers for tagged words
+    static uint32_t index_of(uint64_t word) { return (uint32_t)word; }
+    static uint64_t tagged(uint64_t old_word, uint32_t index) { return ((old_word >> 32) + 1) << 32 | index; }
+};
+
+LockFreeStack::LockFreeStack() : top(NIL), free_top(NIL), used(1)
+{
+    for (int i=0; i < MAX_CHUNKS; i++) {
+        chunks[i].store(NULL, std::memory_order_relaxed);
+    }
+}
+
+LockFreeStack::~LockFreeStack()
+{
+    for (int i=0; i < MAX_CHUNKS; i++) {
+        delete[] chunks[i].load();
+    }
+}
+
+Node* LockFreeStack::node_at(uint32_t index)
+{
+    return &chunks[index / CHUNK_NODES].load(std::memory_order_acquire)[index % CHUNK_NODES];
+}
+
+uint32_t LockFreeStack::allocate_node()
+{
+    // Step 1. Reuse a recycled node if any
+    uint32_t index = pop_node(free_top);
+    if (index != NIL) {
+        return index;
+    }
+
+    // Step 2. Otherwise take the next index, allocating its chunk if needed
+    index = used.fetch_add(1);
+    if (index >= (uint64_t)MAX_CHUNKS * CHUNK_NODES) {
+        used.fetch_sub(1);
+        throw std::runtime_error("stack overflow");
+    }
+    int chunk = index / CHUNK_NODES;
+    if (chunks[chunk].load(std::memory_order_acquire) == NULL) {
+        std::lock_guard<std::mutex> guard(chunk_lock);
+        if (chunks[chunk].load(std::memory_order_relaxed) == NULL) {
+            chunks[chunk].store(new Node[CHUNK_NODES](), std::memory_order_release);
+        }
+    }
+    return index;
+}
+
+void LockFreeStack::push_node(std::atomic<uint64_t>& head, uint32_t index)
+{
+    // Link the node before the current top, then swing the top to it.
+    // Retry if another thread changed the top meanwhile.
+    Node* node = node_at(index);
+    uint64_t old_top = head.load(std::memory_order_relaxed);
+    do {
+        node->next.store(index_of(old_top), std::memory_order_relaxed);
+    } while (!head.compare_exchange_weak(old_top, tagged(old_top, index),
+                                         std::memory_order_release, std::memory_order_relaxed));
+}
+
+uint32_t LockFreeStack::pop_node(std::atomic<uint64_t>& head)
+{
+    // Swing the top to the next node. The node may be popped and reused by
+    // another thread while we read its next index, but then the tag of the
+    // top has changed and the CAS fails.
+    uint64_t old_top = head.load(std::memory_order_acquire);
+    while (index_of(old_top) != NIL) {
+        uint32_t next = node_at(index_of(old_top))->next.load(std::memory_order_relaxed);
+        if (head.compare_exchange_weak(old_top, tagged(old_top, next),
+                                       std::memory_order_acquire, std::memory_order_acquire)) {
+            return index_of(old_top);
+        }
+    }
+    return NIL;
+}
+
+void LockFreeStack::push(int element)
+{
+    // Step 1. Take a node and store the element, the node is ours alone
+    uint32_t index = allocate_node();
+    node_at(index)->element = element;
+
+    // Step 2. Link it on top
+    push_node(top, index);
+}
+
+bool LockFreeStack::pop(int& element)
+{
+    // Step 1. Unlink the top node. Return if the Stack is empty.
+    uint32_t index = pop_node(top);
+    if (index == NIL) {
+        return false;
+    }
+
+    // Step 2. Read the element, the node is ours alone after the CAS
+    element = node_at(index)->element;
+
+    // Step 3. Recycle the node
+    push_node(free_top, index);
+    return true;
+}
+
+void LockFreeStack::print(const std::string& msg)
+{
+    cout << msg << endl;
+    uint32_t index = index_of(top.load());
+    if (index == NIL) {
+        cout << "Stack is Empty" << endl;
+        return;
+    }
+
+    cout << node_at(index)->element << " <-- top" << endl;
+    for (index = node_at(index)->next.load(); index != NIL; index = node_at(index)->next.load()) {
+        cout << node_at(index)->element << endl;
+    }
+}
+
+// Node of the Stack using Linked List, used for comparison
+struct PlainNode
+{
+    int element;
+    PlainNode* next;
+};
+
+// Stack using Linked List behind one mutex, used for comparison
+class MutexStack
+{
+    std::mutex lock;
+    PlainNode* top = NULL;
+
+public:
+    ~MutexStack()
+    {
+        int element;
+        while (pop(element)) {
+        }
+    }
+
+    void push(int element)
+    {
+        PlainNode* node = new PlainNode{ element, NULL };
+        std::lock_guard<std::mutex> guard(lock);
+        node->next = top;
+        top = node;
+    }
+
+    bool pop(int& element)
+    {
+        PlainNode* target;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (top == NULL) {
+                return false;
+            }
+            target = top;
+            top = target->next;
+        }
+        element = target->element;
+        delete target;
+        return true;
+    }
+};
+
+// Every thread pushes two elements and pops two, like a shared work pool
+// Returns the throughput in operations per second
+template<class StackType>
+long long run(int threads, int ops)
+{
+    StackType stack;
+    for (int i=0; i < 1000; i++) {
+        stack.push(i);
+    }
+
+    std::atomic<long long> checksum(0);
+    auto worker = [&](int t) {
+        long long sum = 0;
+        int element;
+        for (int i=0; i < ops / threads / 4; i++) {
+            stack.push(t);
+            stack.push(i);
+            if (stack.pop(element)) {
+                sum += element;
+            }
+            if (stack.pop(element)) {
+                sum += element;
+            }
+        }
+        checksum += sum;
+    };
+
+    auto start = chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t=0; t < threads; t++) {
+        pool.push_back(std::thread(worker, t));
+    }
+    for (size_t t=0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return (long long)(ops / ms * 1000);
+}
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Stack
+    LockFreeStack stack;
+
+    // Push the elements (10, 20, 30 and 40)
+    stack.push(10);
+    stack.push(20);
+    stack.push(30);
+    stack.push(40);
+    stack.print("Stack after inserting 10 20 30 and 40");
+
+    // Pop the elements from Stack
+    int element;
+    stack.pop(element);
+    cout << "Pop element returned " << element << endl;
+    stack.pop(element);
+    cout << "Pop element returned " << element << endl;
+    stack.print("Stack after poping two elements");
+
+    // The next push reuses a popped node
+    stack.push(50);
+    stack.print("Stack after pushing 50");
+
+    // Contention benchmark
+    cout << endl << " THREADS | LOCK-FREE OPS/SEC | MUTEX OPS/SEC" << endl;
+    cout << "---------+-------------------+--------------" << endl;
+    for (int threads=1; threads <= 16; threads *= 2) {
+        long long lock_free = run<LockFreeStack>(threads, 4000000);
+        long long mutex = run<MutexStack>(threads, 4000000);
+        cout.width(8);
+        cout << threads << " | ";
+        cout.width(17);
+        cout << lock_free << " | ";
+        cout.width(13);
+        cout << mutex << endl;
+    }
+}
@@ -0,0 +1,394 @@
+/**
+ * C++ example to demonstrate a Stack of linked Array segments
+ *
+ * The stack of stack_using_array.cpp has a hard capacity, and the stack of
+ * stack_using_linked_list.cpp allocates one node per element. This one
+ * keeps the elements in 4 KiB array segments linked from the top down:
+ * pushes and pops move a pointer inside the top segment, and a segment is
+ * only allocated or freed when the top crosses a segment boundary. The
+ * last emptied segment is cached as a spare, so pushing and popping
+ * around a boundary does not allocate and free over and over.
+ *
+ * Peak memory is measured with glibc's mallinfo2(), so it includes the
+ * allocator overhead of each block.
+ *
+ * Compile with: g++ -std=c++17 -O2 segmented_stack.cpp
+ */
+#include <chrono>
+#include <iostream>
+#include <malloc.h>
+#include <stdexcept>
+#include <string>
+using namespace std;
+
+// Size of a segment in bytes, including its link
+#define SEGMENT_BYTES 4096
+
+/**
+ * Segmented Stack implementation using linked Arrays
+ */
+template<class T>
+class SegmentedStack
+{
+    // Number of elements per segment
+    static constexpr size_t SEGMENT_ELEMENTS = (SEGMENT_BYTES - sizeof(void*)) / sizeof(T);
+
+    /**
+     * Segment Representation
+     */
+    struct Segment
+    {
+        Segment* prev; // Segment below, NULL for the bottom one
+        T data[SEGMENT_ELEMENTS];
+    };
+
+    // Top segment, NULL before the first push
+    Segment* segment;
+
+    // First position, next free position and end of the top segment
+    T* begin;
+    T* top;
+    T* end;
+
+    // Emptied segment kept for the next boundary crossing, or NULL
+    Segment* spare;
+
+    // Number of linked segments, the top one included
+    size_t depth;
+
+    // Number of segments allocated, spare included
+    size_t segments;
+
+public:
+    // Constructor
+    SegmentedStack() : segment(NULL), begin(NULL), top(NULL), end(NULL), spare(NULL), depth(0), segments(0) {}
+
+    // Destructor
+    ~SegmentedStack();
+
+    // Return true if the Stack is empty, false otherwise.
+    bool isEmpty() const { return size() == 0; }
+
+    // Returns the number of elements
+    size_t size() const { return depth == 0 ? 0 : (depth - 1) * SEGMENT_ELEMENTS + (top - begin); }
+
+    // Returns the bytes used by the segments
+    size_t memory() const { return segments * sizeof(Segment); }
+
+    // Returns the top element without deleting
+    // Throws runtime_error if the stack is empty
+    T peek() const;
+
+    // Push the new element to Stack
+    void push(const T& element)
+    {
+        if (top == end) {
+            push_segment();
+        }
+        *top++ = element;
+    }
+
+    // Pop the element from Stack
+    // Throws runtime_error if the stack is empty
+    T pop()
+    {
+        if (top == begin) {
+            pop_segment();
+        }
+        return *--top;
+    }
+
+    // Print the Stack
+    void print(const std::string& msg) const;
+
+private:
+    SegmentedStack(const SegmentedStack&);
+    SegmentedStack& operator=(const SegmentedStack&);
+
+    // Link a new segment on top, the spare one if any
+    void push_segment();
+
+    // Move down to the full segment below, keeping the top one as spare
+    // Throws runtime_error if there is no segment below
+    void pop_segment();
+};
+
+template<class T>
+SegmentedStack<T>::~SegmentedStack()
+{
+    while (segment != NULL) {
+        Segment* target = segment;
+        segment = target->prev;
+        delete target;
+    }
+    delete spare;
+}
+
+template<class T>
+void SegmentedStack<T>::push_segment()
+{
+    // Step 1. Take the spare segment, or allocate one
+    Segment* next = spare;
+    if (next != NULL) {
+        spare = NULL;
+    } else {
+        next = new Segment;
+        segments++;
+    }
+
+    // Step 2. Link it on top and move Top to its first position
+    next->prev = segment;
+    segment = next;
+    begin = top = next->data;
+    end = next->data + SEGMENT_ELEMENTS;
+    depth++;
+}
+
+template<class T>
+void SegmentedStack<T>::pop_segment()
+{
+    // Step 1. Return if the Stack is empty, proceed otherwise
+    if (depth <= 1) {
+        throw std::runtime_error("stack underflow");
+    }
+
+    // Step 2. Keep the empty top segment as spare, freeing the older spare
+    if (spare != NULL) {
+        delete spare;
+        segments--;
+    }
+    spare = segment;
+
+    // Step 3. Move Top past the last element of the segment below
+    segment = segment->prev;
+    begin = segment->data;
+    top = end = segment->data + SEGMENT_ELEMENTS;
+    depth--;
+}
+
+template<class T>
+T SegmentedStack<T>::peek() const
+{
+    if (isEmpty()) {
+        throw std::runtime_error("stack underflow");
+    }
+    if (top == begin) {
+        return segment->prev->data[SEGMENT_ELEMENTS - 1];
+    }
+    return top[-1];
+}
+
+template<class T>
+void SegmentedStack<T>::print(const std::string& msg) const
+{
+    cout << msg << endl;
+    if (isEmpty()) {
+        cout << "Stack is Empty" << endl;
+        return;
+    }
+
+    // Walk the segments from the top down
+    const char* marker = " <-- top";
+    const T* position = top;
+    for (const Segment* s = segment; s != NULL; s = s->prev) {
+        while (position != s->data) {
+            cout << *--position << marker << endl;
+            marker = "";
+        }
+        if (s->prev != NULL) {
+            position = s->prev->data + SEGMENT_ELEMENTS;
+            cout << "-- segment boundary --" << endl;
+        }
+    }
+    cout << "(" << size() << " elements in " << segments << " segments of " << SEGMENT_ELEMENTS
+         << (spare != NULL ? ", one spare)" : ")") << endl;
+}
+
+// Stack using Array, as in stack_using_array.cpp with the capacity given
+// at construction
+struct ArrayStack
+{
+    int* stack;
+    int top = -1;
+    int capacity;
+
+    ArrayStack(int capacity) : stack(new int[capacity]), capacity(capacity) {}
+    ~ArrayStack() { delete[] stack; }
+
+    void push(int element)
+    {
+        if (top == capacity - 1) {
+            throw std::runtime_error("stack overflow");
+        }
+        stack[++top] = element;
+    }
+
+    int pop() { return stack[top--]; }
+};
+
+// Node of the Stack using Linked List, used for comparison
+struct Node
+{
+    int element;
+    Node* next;
+};
+
+// Stack using Linked List, as in stack_using_linked_list.cpp
+struct LinkedStack
+{
+    Node* top = NULL;
+
+    ~LinkedStack()
+    {
+        while (top != NULL) {
+            pop();
+        }
+    }
+
+    void push(int element) { top = new Node{ element, top }; }
+
+    int pop()
+    {
+        Node* target = top;
+        int element = target->element;
+        top = target->next;
+        delete target;
+        return element;
+    }
+};
+
+// Returns the heap bytes in use, small and large blocks
+size_t heap_in_use()
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// Push size elements, then pop them all, in 3 rounds
+// Returns the time in milliseconds and sets the peak heap growth in bytes.
+template<class StackType>
+double fill_and_drain(StackType& stack, int size, size_t base, size_t& peak, long long& sum)
+{
+    auto start = chrono::steady_clock::now();
+    peak = 0;
+    for (int round=0; round < 3; round++) {
+        for (int i=0; i < size; i++) {
+            stack.push(i);
+        }
+        size_t used = heap_in_use() - base;
+        if (used > peak) {
+            peak = used;
+        }
+        for (int i=0; i < size; i++) {
+            sum += stack.pop();
+        }
+    }
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Compare throughput and peak memory against the array and linked stacks
+void benchmark(int size)
+{
+    long long sum = 0;
+    size_t segmented_peak, array_peak, linked_peak;
+
+    size_t base = heap_in_use();
+    double segmented_ms;
+    {
+        SegmentedStack<int> stack;
+        segmented_ms = fill_and_drain(stack, size, base, segmented_peak, sum);
+    }
+
+    // The array stack must be created with its worst case capacity
+    base = heap_in_use();
+    double array_ms;
+    {
+        ArrayStack stack(size);
+        array_ms = fill_and_drain(stack, size, base, array_peak, sum);
+    }
+
+    base = heap_in_use();
+    double linked_ms;
+    {
+        LinkedStack stack;
+        linked_ms = fill_and_drain(stack, size, base, linked_peak, sum);
+    }
+
+    cout.width(9);
+    cout << size << " | ";
+    cout.width(8);
+    cout << segmented_ms << " ms ";
+    cout.width(9);
+    cout << segmented_peak / 1024 << " KiB | ";
+    cout.width(8);
+    cout << array_ms << " ms ";
+    cout.width(9);
+    cout << array_peak / 1024 << " KiB | ";
+    cout.width(8);
+    cout << linked_ms << " ms ";
+    cout.width(9);
+    cout << linked_peak / 1024 << " KiB" << endl;
+}
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Stack
+    SegmentedStack<int> stack;
+
+    // Push the elements (10, 20, 30 and 40)
+    stack.push(10);
+    stack.push(20);
+    stack.push(30);
+    stack.push(40);
+    stack.print("Stack after inserting 10 20 30 and 40");
+
+    // Pop the elements from Stack
+    int element = stack.pop();
+    cout << "Pop element returned " << element << endl;
+    element = stack.pop();
+    cout << "Pop element returned " << element << endl;
+    stack.print("Stack after poping two elements");
+
+    // Cross a segment boundary: 1022 ints fit in a segment
+    for (int i=0; i < 1021; i++) {
+        stack.push(i);
+    }
+    cout << "Peek element after crossing a segment returned " << stack.peek() << endl;
+    for (int i=0; i < 1021; i++) {
+        stack.pop();
+    }
+    stack.print("Stack after popping back below the boundary");
+
+    // Pop past the bottom
+    try {
+        stack.pop();
+        stack.pop();
+        stack.pop();
+    } catch (const std::exception& e) {
+        cout << "Pop: exception received: " << e.what() << endl;
+    }
+
+    // Push and pop around a boundary: the spare segment avoids allocations
+    for (int i=0; i < 1022; i++) {
+        stack.push(i);
+    }
+    size_t before = stack.memory();
+    auto start = chrono::steady_clock::now();
+    for (int i=0; i < 10000000; i++) {
+        stack.push(i);
+        stack.pop();
+        stack.pop();
+        stack.push(i);
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << endl << "10M push/pop pairs around a boundary: " << ms << " ms, segment bytes "
+         << before << " -> " << stack.memory() << endl;
+
+    // Throughput and peak memory
+    cout << endl << " ELEMENTS |          SEGMENTED          |        ARRAY (PRESIZED)     |           LINKED" << endl;
+    cout << "----------+-----------------------------+-----------------------------+----------------------------" << endl;
+    for (int size=1000; size <= 10000000; size *= 10) {
+        benchmark(size);
+    }
+}
@@ -0,0 +1,365 @@
+/**
+ * C++ example to demonstrate a growable Queue using a Ring Buffer
+ *
+ * The queue of queue_using_array.cpp only moves its front forward, so it
+ * reports full once the rear reaches the end even when the slots before
+ * the front are free. This one wraps around: the slot of the i-th element
+ * is (front + i) & mask with a power-of-two capacity. When the ring is
+ * full it is unrolled into an array of twice the size with two memcpy
+ * calls, front to the end of the array then the start of the array up to
+ * rear, so the front lands at slot 0 again.
+ *
+ * enqueue_n()/dequeue_n() move whole spans the same way, at most two
+ * memcpy calls across the wrap point.
+ *
+ * Compile with: g++ -std=c++17 -O2 growable_queue.cpp
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+/**
+ * Growable Queue implementation using a Ring Buffer
+ * T must be trivially copyable since the elements are moved with memcpy.
+ */
+template<class T>
+class GrowableQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "elements must be trivially copyable");
+
+    // Queue data
+    T* queue;
+
+    // Slot of the front element
+    size_t front;
+
+    // Number of elements
+    size_t count;
+
+    // Number of slots, a power of two, or 0 before the first enqueue
+    size_t capacity;
+
+public:
+    // Constructor
+    GrowableQueue() : queue(NULL), front(0), count(0), capacity(0) {}
+
+    // Destructor
+    ~GrowableQueue() { ::operator delete(queue); }
+
+    // Return true if the Queue is empty, false otherwise.
+    bool isEmpty() const { return count == 0; }
+
+    // Returns the number of elements
+    size_t size() const { return count; }
+
+    // Make room for at least the given number of elements
+    void reserve(size_t min_capacity);
+
+    // Returns the Front element without deleting it
+    // Throws runtime_error if the queue is empty
+    T peek() const;
+
+    // Enqueue new element to the Queue, growing the ring if full
+    void enqueue(const T& element)
+    {
+        if (count == capacity) {
+            T copy = element; // The element may live in the ring being released
+            grow(count + 1);
+            queue[count++] = copy;
+            return;
+        }
+        queue[(front + count++) & (capacity - 1)] = element;
+    }
+
+    // Dequeue the element from Queue
+    // Throws runtime_error if the queue is empty
+    T dequeue()
+    {
+        if (isEmpty()) {
+            throw std::runtime_error("queue underflow");
+        }
+        T element = queue[front];
+        front = (front + 1) & (capacity - 1);
+        count--;
+        return element;
+    }
+
+    // Enqueue n elements, values[0] first
+    // The values may be elements of this queue.
+    void enqueue_n(const T* values, size_t n);
+
+    // Dequeue n elements into out, the front one in out[0]
+    // Throws runtime_error if the queue holds fewer than n elements
+    void dequeue_n(T* out, size_t n);
+
+    // Traverse and display the Queue
+    void display(const std::string& msg) const;
+
+private:
+    GrowableQueue(const GrowableQueue&);
+    GrowableQueue& operator=(const GrowableQueue&);
+
+    // Unroll the ring into a larger array, doubling the capacity at least
+    void grow(size_t min_capacity);
+};
+
+template<class T>
+void GrowableQueue<T>::grow(size_t min_capacity)
+{
+    // Step 1. Double the capacity, or more if requested, as a power of two
+    size_t new_capacity = capacity < 8 ? 8 : capacity * 2;
+    while (new_capacity < min_capacity) {
+        new_capacity *= 2;
+    }
+
+    // Step 2. Copy front..end of the array, then start of the array..rear,
+    // so the front element lands at slot 0
+    T* new_queue = static_cast<T*>(::operator new(new_capacity * sizeof(T)));
+    size_t first = std::min(count, capacity - front);
+    if (first > 0) {
+        std::memcpy(new_queue, queue + front, first * sizeof(T));
+    }
+    if (count > first) {
+        std::memcpy(new_queue + first, queue, (count - first) * sizeof(T));
+    }
+    ::operator delete(queue);
+    queue = new_queue;
+    front = 0;
+    capacity = new_capacity;
+}
+
+template<class T>
+void GrowableQueue<T>::reserve(size_t min_capacity)
+{
+    if (min_capacity > capacity) {
+        grow(min_capacity);
+    }
+}
+
+template<class T>
+T GrowableQueue<T>::peek() const
+{
+    if (isEmpty()) {
+        throw std::runtime_error("queue underflow");
+    }
+    return queue[front];
+}
+
+template<class T>
+void GrowableQueue<T>::enqueue_n(const T* values, size_t n)
+{
+    // Step 1. Make room for all the elements at once. The values may live
+    // in the ring being released: then enqueue a copy of them.
+    if (count + n > capacity) {
+        if (std::less_equal<const T*>()(queue, values) && std::less<const T*>()(values, queue + capacity)) {
+            std::vector<T> copy(values, values + n);
+            grow(count + n);
+            enqueue_n(copy.data(), n);
+            return;
+        }
+        grow(count + n);
+    }
+    if (n == 0) {
+        return;
+    }
+
+    // Step 2. Copy up to the end of the array, then the rest from its start
+    size_t rear = (front + count) & (capacity - 1);
+    size_t first = std::min(n, capacity - rear);
+    std::memcpy(queue + rear, values, first * sizeof(T));
+    if (n > first) {
+        std::memcpy(queue, values + first, (n - first) * sizeof(T));
+    }
+    count += n;
+}
+
+template<class T>
+void GrowableQueue<T>::dequeue_n(T* out, size_t n)
+{
+    // Step 1. Check if there are enough elements
+    if (n > count) {
+        throw std::runtime_error("queue underflow");
+    }
+    if (n == 0) {
+        return;
+    }
+
+    // Step 2. Copy up to the end of the array, then the rest from its start
+    size_t first = std::min(n, capacity - front);
+    std::memcpy(out, queue + front, first * sizeof(T));
+    if (n > first) {
+        std::memcpy(out + first, queue, (n - first) * sizeof(T));
+    }
+    front = (front + n) & (capacity - 1);
+    count -= n;
+}
+
+template<class T>
+void GrowableQueue<T>::display(const std::string& msg) const
+{
+    cout << msg << endl;
+    if (isEmpty()) {
+        cout << "Queue is Empty" << endl;
+        return;
+    }
+
+    cout << "IDX ELEMENT" << endl;
+    cout << "---+-------" << endl;
+    for (size_t i=0; i < count; i++) {
+        size_t slot = (front + i) & (capacity - 1);
+        cout << "[" << slot << "] " << queue[slot];
+        if (i == 0) {
+            cout << (count == 1 ? " <-- front, rear" : " <-- front");
+        } else if (i == count - 1) {
+            cout << " <-- rear";
+        }
+        cout << endl;
+    }
+    cout << "(" << count << " of " << capacity << ")" << endl;
+}
+
+// Compare against std::queue on a deque
+void benchmark(int size, int rounds)
+{
+    long long sum = 0;
+
+    // Steady state: keep size elements queued, enqueue and dequeue one each.
+    // Only the pairs are timed, the filling is part of the bulk test below.
+    double growable_steady_ms, std_steady_ms;
+    {
+        GrowableQueue<int> queue;
+        for (int i=0; i < size; i++) {
+            queue.enqueue(i);
+        }
+        auto start = chrono::steady_clock::now();
+        for (int i=0; i < rounds; i++) {
+            queue.enqueue(i);
+            sum += queue.dequeue();
+        }
+        growable_steady_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    {
+        std::queue<int, std::deque<int>> queue;
+        for (int i=0; i < size; i++) {
+            queue.push(i);
+        }
+        auto start = chrono::steady_clock::now();
+        for (int i=0; i < rounds; i++) {
+            queue.push(i);
+            sum -= queue.front();
+            queue.pop();
+        }
+        std_steady_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    // Bulk: enqueue then dequeue size elements, one by one or by 64
+    std::vector<int> batch(64);
+    for (int i=0; i < 64; i++) {
+        batch[i] = i;
+    }
+    auto start = chrono::steady_clock::now();
+    {
+        GrowableQueue<int> queue;
+        for (int round=0; round < 3; round++) {
+            for (int i=0; i < size; i++) {
+                queue.enqueue(i);
+            }
+            for (int i=0; i < size; i++) {
+                sum += queue.dequeue();
+            }
+        }
+    }
+    double growable_bulk_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    {
+        GrowableQueue<int> queue;
+        for (int round=0; round < 3; round++) {
+            for (int i=0; i < size; i += 64) {
+                queue.enqueue_n(batch.data(), 64);
+            }
+            while (!queue.isEmpty()) {
+                queue.dequeue_n(batch.data(), 64);
+                sum -= batch[63];
+            }
+        }
+    }
+    double batch_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    {
+        std::queue<int, std::deque<int>> queue;
+        for (int round=0; round < 3; round++) {
+            for (int i=0; i < size; i++) {
+                queue.push(i);
+            }
+            for (int i=0; i < size; i++) {
+                sum -= queue.front();
+                queue.pop();
+            }
+        }
+    }
+    double std_bulk_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << rounds << " enqueue/dequeue pairs at depth " << size << endl;
+    cout << "  GrowableQueue " << growable_steady_ms << " ms, std::queue " << std_steady_ms << " ms" << endl;
+    cout << "3 rounds of enqueue and dequeue of " << size << " elements (checksum " << sum << ")" << endl;
+    cout << "  GrowableQueue " << growable_bulk_ms << " ms, enqueue_n/dequeue_n by 64 " << batch_ms
+         << " ms, std::queue " << std_bulk_ms << " ms" << endl;
+}
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Queue
+    GrowableQueue<int> queue;
+
+    // Enqueue elements (10, 20, 30, 40, and 50)
+    queue.enqueue(10);
+    queue.enqueue(20);
+    queue.enqueue(30);
+    queue.enqueue(40);
+    queue.enqueue(50);
+    queue.display("Queue after inserting 10 20 30 40 and 50");
+
+    // Dequeue the elements from Queue
+    int element = queue.dequeue();
+    cout << "Dequeue element returned " << element << endl;
+    element = queue.dequeue();
+    cout << "Dequeue element returned " << element << endl;
+
+    // Enqueue elements (60, 70, 80 and 90) across the wrap point
+    int values[] = { 60, 70, 80, 90 };
+    queue.enqueue_n(values, 4);
+    queue.display("Queue after enqueue_n(60 70 80 90)");
+
+    // 100 fills the ring, and 110 unrolls it into 16 slots
+    queue.enqueue(100);
+    queue.enqueue(110);
+    queue.display("Queue after inserting 100 and 110");
+
+    int out[4];
+    queue.dequeue_n(out, 4);
+    cout << "dequeue_n(4) returned " << out[0] << " " << out[1] << " " << out[2] << " " << out[3] << endl;
+
+    // Dequeue past the rear
+    try {
+        queue.dequeue_n(out, 4);
+    } catch (const std::exception& e) {
+        cout << "dequeue_n(4): exception received: " << e.what() << endl;
+    }
+
+    cout << endl;
+    benchmark(1000, 50000000);
+    benchmark(10000000, 10000000);
+}
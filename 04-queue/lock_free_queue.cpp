@@ -0,0 +1,641 @@
+/**
+ * C++ example to demonstrate a lock-free Queue (Michael-Scott queue)
+ *
+ * The queue of queue_using_linked_list.cpp made safe for many threads
+ * without locks, after Michael and Scott:
+ *
+ * - The list always starts with a dummy node, so front and rear never
+ *   need to be updated together. The first element is the dummy's next.
+ * - Enqueue links the new node with a CAS on the last node's next, then
+ *   swings rear with a second CAS. A thread which finds rear lagging
+ *   behind the real last node helps by swinging it first.
+ * - Dequeue swings front to the dummy's next with a CAS, the next node
+ *   becoming the new dummy, and retires the old dummy.
+ *
+ * A retired node may still be read by a thread which loaded front just
+ * before the CAS, so it is not reused right away. Each thread publishes
+ * the nodes it is about to read as hazard pointers, and a retired node is
+ * recycled only once no hazard pointer refers to it (Michael's hazard
+ * pointers). Recycled nodes go to a per-thread free list, balanced
+ * through a shared pool in batches, so the steady state does not
+ * allocate even when producers and consumers are different threads.
+ *
+ * Compile with: g++ -std=c++17 -O2 -pthread lock_free_queue.cpp
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Maximum number of threads using the queues at the same time
+#define MAX_THREADS 256
+
+// Number of retired nodes which triggers a scan of the hazard pointers
+#define RETIRE_THRESHOLD 256
+
+// Number of free nodes moved at once between a thread and the shared pool
+#define FREE_BATCH 64
+
+/**
+ * Queue Node Representation
+ */
+struct Node
+{
+    int element;
+    std::atomic<Node*> next;
+};
+
+/**
+ * Hazard pointers of one thread, on its own cache line
+ */
+struct alignas(64) HazardRecord
+{
+    std::atomic<Node*> hazard[2];
+    std::atomic<bool> in_use;
+};
+
+/**
+ * Hazard pointers and node recycling shared by all the queues
+ */
+class NodeDomain
+{
+    // Hazard records, the first record_count ever used
+    HazardRecord records[MAX_THREADS];
+    std::atomic<int> record_count;
+
+    // Free nodes shared between threads, and retired nodes left by
+    // threads which exited while the nodes were still hazardous
+    std::mutex lock;
+    std::vector<Node*> pool;
+    std::vector<Node*> orphans;
+
+    // Number of nodes ever allocated
+    std::atomic<long long> allocated;
+
+public:
+    NodeDomain();
+    ~NodeDomain();
+
+    // Returns a free node, recycled if possible
+    Node* allocate();
+
+    // Retire a node unlinked from a queue, recycling it once safe
+    void retire(Node* node);
+
+    // Recycle a node no other thread can read
+    void release(Node* node);
+
+    // Publish the node held by the source as hazard slot i
+    // Returns the node, still held by the source after publishing.
+    Node* protect(int i, const std::atomic<Node*>& source);
+
+    // Publish a node as hazard slot i
+    void set_hazard(int i, Node* node);
+
+    // Clear both hazard slots of the thread
+    void clear_hazards();
+
+    // Returns the number of nodes ever allocated
+    long long allocations() const { return allocated.load(); }
+
+private:
+    /**
+     * Per-thread state: its hazard record and its node lists
+     */
+    struct ThreadState
+    {
+        NodeDomain* domain = NULL;
+        HazardRecord* record = NULL;
+        std::vector<Node*> retired;
+        std::vector<Node*> free;
+        ~ThreadState();
+    };
+
+    // Returns the thread's state, taking a hazard record on first use
+    ThreadState& state();
+
+    // Recycle the retired nodes no hazard pointer refers to
+    void scan(ThreadState& thread);
+
+    friend struct ThreadState;
+};
+
+// Domain of all the queues
+NodeDomain domain;
+
+NodeDomain::NodeDomain() : record_count(0), allocated(0)
+{
+    for (int i=0; i < MAX_THREADS; i++) {
+        records[i].hazard[0].store(NULL);
+        records[i].hazard[1].store(NULL);
+        records[i].in_use.store(false);
+    }
+}
+
+NodeDomain::~NodeDomain()
+{
+    // No thread uses the queues any more
+    for (size_t i=0; i < pool.size(); i++) {
+        delete pool[i];
+    }
+    for (size_t i=0; i < orphans.size(); i++) {
+        delete orphans[i];
+    }
+}
+
+NodeDomain::ThreadState& NodeDomain::state()
+{
+    static thread_local ThreadState thread;
+    if (thread.record != NULL) {
+        return thread;
+    }
+
+    // Take a free record, or a new one
+    for (int i=0; i < MAX_THREADS; i++) {
+        bool expected = false;
+        if (!records[i].in_use.load() && records[i].in_use.compare_exchange_strong(expected, true)) {
+            int count = record_count.load();
+            while (count <= i && !record_count.compare_exchange_weak(count, i + 1)) {
+            }
+            thread.domain = this;
+            thread.record = &records[i];
+            return thread;
+        }
+    }
+    throw std::runtime_error("too many threads");
+}
+
+NodeDomain::ThreadState::~ThreadState()
+{
+    if (record == NULL) {
+        return;
+    }
+
+    // Step 1. Recycle what is safe, hand the rest to the domain
+    domain->scan(*this);
+    std::lock_guard<std::mutex> guard(domain->lock);
+    domain->orphans.insert(domain->orphans.end(), retired.begin(), retired.end());
+    domain->pool.insert(domain->pool.end(), free.begin(), free.end());
+
+    // Step 2. Release the hazard record
+    record->hazard[0].store(NULL);
+    record->hazard[1].store(NULL);
+    record->in_use.store(false);
+}
+
+Node* NodeDomain::allocate()
+{
+    ThreadState& thread = state();
+
+    // Step 1. Refill the free list from the shared pool if empty
+    if (thread.free.empty()) {
+        std::lock_guard<std::mutex> guard(lock);
+        size_t n = std::min(pool.size(), (size_t)FREE_BATCH);
+        thread.free.insert(thread.free.end(), pool.end() - n, pool.end());
+        pool.resize(pool.size() - n);
+    }
+
+    // Step 2. Take a free node, or allocate one
+    if (!thread.free.empty()) {
+        Node* node = thread.free.back();
+        thread.free.pop_back();
+        return node;
+    }
+    allocated.fetch_add(1, std::memory_order_relaxed);
+    return new Node();
+}
+
+void NodeDomain::retire(Node* node)
+{
+    ThreadState& thread = state();
+    thread.retired.push_back(node);
+    if (thread.retired.size() >= RETIRE_THRESHOLD) {
+        scan(thread);
+    }
+}
+
+void NodeDomain::release(Node* node)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    pool.push_back(node);
+}
+
+void NodeDomain::scan(ThreadState& thread)
+{
+    // Step 1. Collect the hazard pointers of all the threads, and adopt
+    // the orphans of exited threads
+    std::vector<Node*> hazards;
+    int count = record_count.load();
+    for (int i=0; i < count; i++) {
+        for (int h=0; h < 2; h++) {
+            Node* node = records[i].hazard[h].load();
+            if (node != NULL) {
+                hazards.push_back(node);
+            }
+        }
+    }
+    std::sort(hazards.begin(), hazards.end());
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        thread.retired.insert(thread.retired.end(), orphans.begin(), orphans.end());
+        orphans.clear();
+    }
+
+    // Step 2. Free the retired nodes not in the hazards, keep the others
+    size_t kept = 0;
+    for (size_t i=0; i < thread.retired.size(); i++) {
+        Node* node = thread.retired[i];
+        if (std::binary_search(hazards.begin(), hazards.end(), node)) {
+            thread.retired[kept++] = node;
+        } else {
+            thread.free.push_back(node);
+        }
+    }
+    thread.retired.resize(kept);
+
+    // Step 3. Give a batch back to the shared pool if the free list is long
+    if (thread.free.size() >= 2 * FREE_BATCH) {
+        std::lock_guard<std::mutex> guard(lock);
+        pool.insert(pool.end(), thread.free.end() - FREE_BATCH, thread.free.end());
+        thread.free.resize(thread.free.size() - FREE_BATCH);
+    }
+}
+
+Node* NodeDomain::protect(int i, const std::atomic<Node*>& source)
+{
+    // Publish the node, then check the source still holds it. If so, the
+    // node was not retired before the hazard became visible to scans.
+    std::atomic<Node*>& hazard = state().record->hazard[i];
+    Node* node = source.load();
+    for (;;) {
+        hazard.store(node);
+        Node* current = source.load();
+        if (current == node) {
+            return node;
+        }
+        node = current;
+    }
+}
+
+void NodeDomain::set_hazard(int i, Node* node)
+{
+    state().record->hazard[i].store(node);
+}
+
+void NodeDomain::clear_hazards()
+{
+    HazardRecord* record = state().record;
+    record->hazard[0].store(NULL, std::memory_order_release);
+    record->hazard[1].store(NULL, std::memory_order_release);
+}
+
+/**
+ * Lock-free Queue implementation using Linked List
+ */
+class LockFreeQueue
+{
+    // Dummy node before the first element
+    alignas(64) std::atomic<Node*> front;
+
+    // Last node, or a node before it while an enqueue is in progress
+    alignas(64) std::atomic<Node*> rear;
+
+public:
+    // Constructor
+    LockFreeQueue();
+
+    // Destructor, only once no other thread uses the queue
+    ~LockFreeQueue();
+
+    // Enqueue new element to Queue
+    void enqueue(int element);
+
+    // Dequeue an element from Queue
+    // Returns true and sets the element on success, false if the queue is empty.
+    bool dequeue(int& element);
+
+    // Traverse and display the Queue, only while no other thread uses it
+    void display(const std::string& msg);
+};
+
+LockFreeQueue::LockFreeQueue()
+{
+    Node* dummy = domain.allocate();
+    dummy->next.store(NULL);
+    front.store(dummy);
+    rear.store(dummy);
+}
+
+LockFreeQueue::~LockFreeQueue()
+{
+    Node* node = front.load();
+    while (node != NULL) {
+        Node* next = node->next.load();
+        domain.release(node);
+        node = next;
+    }
+}
+
+void LockFreeQueue::enqueue(int element)
+{
+    // Step 1. Create the new node
+    Node* node = domain.allocate();
+    node->element = element;
+    node->next.store(NULL, std::memory_order_relaxed);
+
+    for (;;) {
+        // Step 2. Read the rear node and its next
+        Node* last = domain.protect(0, rear);
+        Node* next = last->next.load(std::memory_order_acquire);
+        if (last != rear.load()) {
+            continue;
+        }
+
+        // Step 3. If rear lags behind the last node, help swing it and retry
+        if (next != NULL) {
+            rear.compare_exchange_strong(last, next);
+            continue;
+        }
+
+        // Step 4. Link the new node after the last one, then swing rear to
+        // it. If the second CAS fails, another thread already helped.
+        if (last->next.compare_exchange_strong(next, node, std::memory_order_release, std::memory_order_relaxed)) {
+            rear.compare_exchange_strong(last, node);
+            break;
+        }
+    }
+    domain.clear_hazards();
+}
+
+bool LockFreeQueue::dequeue(int& element)
+{
+    for (;;) {
+        // Step 1. Read the dummy node, its next and the rear node
+        Node* first = domain.protect(0, front);
+        Node* last = rear.load();
+        Node* next = first->next.load(std::memory_order_acquire);
+        domain.set_hazard(1, next);
+        if (first != front.load()) {
+            continue;
+        }
+
+        // Step 2. Return if the Queue is empty
+        if (next == NULL) {
+            domain.clear_hazards();
+            return false;
+        }
+
+        // Step 3. If rear still points to the dummy, help swing it and retry
+        if (first == last) {
+            rear.compare_exchange_strong(last, next);
+            continue;
+        }
+
+        // Step 4. Read the element and make its node the new dummy
+        int value = next->element;
+        if (front.compare_exchange_strong(first, next)) {
+            domain.clear_hazards();
+            domain.retire(first);
+            element = value;
+            return true;
+        }
+    }
+}
+
+void LockFreeQueue::display(const std::string& msg)
+{
+    cout << msg << endl;
+    Node* node = front.load()->next.load();
+    if (node == NULL) {
+        cout << "Queue is Empty" << endl;
+        return;
+    }
+
+    if (node->next.load() == NULL) {
+        cout << node->element << " <-- front, rear" << endl;
+        return;
+    }
+
+    cout << node->element << " <-- front" << endl;
+    for (node = node->next.load(); node->next.load() != NULL; node = node->next.load()) {
+        cout << node->element << endl;
+    }
+    cout << node->element << " <-- rear" << endl;
+}
+
+// Node of the Queue using Linked List, used for comparison
+struct PlainNode
+{
+    int element;
+    PlainNode* next;
+};
+
+// Queue using Linked List behind one mutex, used for comparison
+class MutexQueue
+{
+    std::mutex lock;
+    PlainNode* front = NULL;
+    PlainNode* rear = NULL;
+
+public:
+    ~MutexQueue()
+    {
+        int element;
+        while (dequeue(element)) {
+        }
+    }
+
+    void enqueue(int element)
+    {
+        PlainNode* node = new PlainNode{ element, NULL };
+        std::lock_guard<std::mutex> guard(lock);
+        if (rear == NULL) {
+            front = node;
+        } else {
+            rear->next = node;
+        }
+        rear = node;
+    }
+
+    bool dequeue(int& element)
+    {
+        PlainNode* target;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (front == NULL) {
+                return false;
+            }
+            target = front;
+            front = target->next;
+            if (front == NULL) {
+                rear = NULL;
+            }
+        }
+        element = target->element;
+        delete target;
+        return true;
+    }
+};
+
+// Bounded MPMC Queue using Array, as in mpmc_ring_buffer.cpp
+class RingQueue
+{
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        int element;
+    };
+
+    alignas(64) Cell* buffer;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueue_position{ 0 };
+    alignas(64) std::atomic<size_t> dequeue_position{ 0 };
+
+public:
+    RingQueue(size_t capacity) : buffer(new Cell[capacity]), mask(capacity - 1)
+    {
+        for (size_t i=0; i < capacity; i++) {
+            buffer[i].sequence.store(i);
+        }
+    }
+    ~RingQueue() { delete[] buffer; }
+
+    bool enqueue(int element)
+    {
+        size_t position = enqueue_position.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = buffer[position & mask];
+            intptr_t lag = (intptr_t)cell.sequence.load(std::memory_order_acquire) - (intptr_t)position;
+            if (lag == 0 && enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.element = element;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            } else if (lag < 0) {
+                return false;
+            } else if (lag > 0) {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool dequeue(int& element)
+    {
+        size_t position = dequeue_position.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = buffer[position & mask];
+            intptr_t lag = (intptr_t)cell.sequence.load(std::memory_order_acquire) - (intptr_t)(position + 1);
+            if (lag == 0 && dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                element = cell.element;
+                cell.sequence.store(position + mask + 1, std::memory_order_release);
+                return true;
+            } else if (lag < 0) {
+                return false;
+            } else if (lag > 0) {
+                position = dequeue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Adapter giving the unbounded queues the ring's enqueue signature
+template<class QueueType>
+struct Unbounded : QueueType
+{
+    bool enqueue(int element)
+    {
+        QueueType::enqueue(element);
+        return true;
+    }
+};
+
+// Move count messages from producers to as many consumers, retrying with
+// a yield when the queue is full or empty
+// Returns the throughput in messages per second
+template<class QueueType>
+long long run(QueueType& queue, int pairs, int count)
+{
+    std::atomic<long long> checksum(0);
+    auto start = chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int p=0; p < pairs; p++) {
+        pool.push_back(std::thread([&, p]() {
+            for (int i=p; i < count; i += pairs) {
+                while (!queue.enqueue(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+        pool.push_back(std::thread([&, p]() {
+            long long sum = 0;
+            int element;
+            for (int i=p; i < count; i += pairs) {
+                while (!queue.dequeue(element)) {
+                    std::this_thread::yield();
+                }
+                sum += element;
+            }
+            checksum += sum;
+        }));
+    }
+    for (size_t t=0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    if (checksum != (long long)(count - 1) * count / 2) {
+        cout << "checksum mismatch" << endl;
+    }
+    return (long long)(count / ms * 1000);
+}
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Queue
+    LockFreeQueue queue;
+
+    // Enqueue elements (10, 20, 30 and 40)
+    queue.enqueue(10);
+    queue.enqueue(20);
+    queue.enqueue(30);
+    queue.enqueue(40);
+    queue.display("Queue after inserting 10 20 30 and 40");
+
+    // Dequeue the elements from Queue
+    int element;
+    queue.dequeue(element);
+    cout << "Dequeue element returned " << element << endl;
+    queue.dequeue(element);
+    cout << "Dequeue element returned " << element << endl;
+    queue.display("Queue after removing 10 and 20");
+
+    // Benchmark, producer/consumer pairs
+    const int count = 4000000;
+    cout << endl << " PAIRS | LOCK-FREE MSG/SEC | NEW NODES | MUTEX MSG/SEC | MPMC RING MSG/SEC" << endl;
+    cout << "-------+-------------------+-----------+---------------+------------------" << endl;
+    for (int pairs=1; pairs <= 16; pairs *= 2) {
+        Unbounded<LockFreeQueue> lock_free;
+        Unbounded<MutexQueue> mutex;
+        RingQueue ring(1024);
+        long long allocations = domain.allocations();
+        long long lock_free_rate = run(lock_free, pairs, count);
+        long long mutex_rate = run(mutex, pairs, count);
+        long long ring_rate = run(ring, pairs, count);
+        cout.width(6);
+        cout << pairs << " | ";
+        cout.width(17);
+        cout << lock_free_rate << " | ";
+        cout.width(9);
+        cout << domain.allocations() - allocations << " | ";
+        cout.width(13);
+        cout << mutex_rate << " | ";
+        cout.width(16);
+        cout << ring_rate << endl;
+    }
+}
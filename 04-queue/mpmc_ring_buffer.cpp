@@ -0,0 +1,393 @@
+/**
+ * C++ example to demonstrate a bounded Multi-Producer Multi-Consumer Queue
+ *
+ * The circular array queue made safe for any number of producer and
+ * consumer threads, following Dmitry Vyukov's bounded MPMC queue:
+ *
+ * - Every cell of the array carries a sequence number. Cell i starts with
+ *   sequence i. A producer at position p may fill the cell when its
+ *   sequence equals p, and then sets it to p + 1. A consumer at position p
+ *   may empty it when its sequence equals p + 1, and then sets it to
+ *   p + capacity, the position of the next lap's producer.
+ * - Producers claim positions with a CAS on the enqueue position and
+ *   consumers with a CAS on the dequeue position. Both live on their own
+ *   cache line, so producers and consumers do not contend with each other.
+ *
+ * BlockingMpmcQueue wraps it for a thread pool: a thread which finds the
+ * queue full (or empty) first spins, then yields its core, then sleeps on
+ * a futex until the other side changes the queue. Futexes are Linux only.
+ *
+ * Compile with: g++ -std=c++17 -O2 -pthread mpmc_ring_buffer.cpp
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <linux/futex.h>
+#include <string>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+using namespace std;
+
+// Number of spins, then of yields, before a blocked thread sleeps
+#define SPIN_LIMIT 64
+#define YIELD_LIMIT 16
+
+/**
+ * Bounded MPMC Queue implementation using Array
+ */
+template<class T>
+class MpmcRingBuffer
+{
+    /**
+     * Queue Cell Representation
+     */
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T element;
+    };
+
+    // Read only: the cells and capacity - 1
+    alignas(64) Cell* buffer;
+    size_t mask;
+
+    // Next position to fill, claimed by producers
+    alignas(64) std::atomic<size_t> enqueue_position;
+
+    // Next position to empty, claimed by consumers
+    alignas(64) std::atomic<size_t> dequeue_position;
+
+public:
+    // Constructor, rounding the capacity up to a power of two of at least 2
+    MpmcRingBuffer(size_t capacity);
+
+    // Destructor
+    ~MpmcRingBuffer() { delete[] buffer; }
+
+    // Returns the number of cells
+    size_t capacity() const { return mask + 1; }
+
+    // Enqueue new element to the Queue
+    // Returns false if the queue is full.
+    bool try_push(const T& element);
+
+    // Dequeue the element from Queue
+    // Returns false if the queue is empty.
+    bool try_pop(T& element);
+
+    // Print the Queue, only while no other thread uses it
+    void display(const std::string& msg);
+
+private:
+    MpmcRingBuffer(const MpmcRingBuffer&);
+    MpmcRingBuffer& operator=(const MpmcRingBuffer&);
+};
+
+template<class T>
+MpmcRingBuffer<T>::MpmcRingBuffer(size_t capacity) : enqueue_position(0), dequeue_position(0)
+{
+    size_t cells = 2;
+    while (cells < capacity) {
+        cells *= 2;
+    }
+    buffer = new Cell[cells];
+    mask = cells - 1;
+    for (size_t i=0; i < cells; i++) {
+        buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<class T>
+bool MpmcRingBuffer<T>::try_push(const T& element)
+{
+    // Step 1. Claim the enqueue position once its cell is free
+    Cell* cell;
+    size_t position = enqueue_position.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &buffer[position & mask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t lag = (intptr_t)sequence - (intptr_t)position;
+        if (lag == 0) {
+            // The cell is free for this lap: try to claim the position
+            if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lag < 0) {
+            // The cell still holds the previous lap's element: full
+            return false;
+        } else {
+            // Another producer claimed the position: catch up
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Step 2. Fill the cell and hand it to the consumer of this position
+    cell->element = element;
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template<class T>
+bool MpmcRingBuffer<T>::try_pop(T& element)
+{
+    // Step 1. Claim the dequeue position once its cell is filled
+    Cell* cell;
+    size_t position = dequeue_position.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &buffer[position & mask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t lag = (intptr_t)sequence - (intptr_t)(position + 1);
+        if (lag == 0) {
+            if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lag < 0) {
+            // The cell is not filled yet: empty
+            return false;
+        } else {
+            position = dequeue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Step 2. Empty the cell and hand it to the producer of the next lap
+    element = cell->element;
+    cell->sequence.store(position + mask + 1, std::memory_order_release);
+    return true;
+}
+
+template<class T>
+void MpmcRingBuffer<T>::display(const std::string& msg)
+{
+    cout << msg << endl;
+    size_t front = dequeue_position.load();
+    size_t rear = enqueue_position.load();
+    if (front == rear) {
+        cout << "Queue is Empty" << endl;
+        return;
+    }
+
+    cout << "IDX SEQ ELEMENT" << endl;
+    cout << "---+---+-------" << endl;
+    for (size_t position=front; position != rear; position++) {
+        Cell& cell = buffer[position & mask];
+        cout << "[" << (position & mask) << "] " << cell.sequence.load() << "   " << cell.element;
+        if (position == front) {
+            cout << " <-- front";
+        }
+        if (position == rear - 1) {
+            cout << (position == front ? ", rear" : " <-- rear");
+        }
+        cout << endl;
+    }
+}
+
+// Sleep while the futex word holds the expected value
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+// Wake one thread sleeping on the futex word
+void futex_wake(std::atomic<uint32_t>& word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+// Spin hint to the processor
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * Blocking MPMC Queue: spin, then yield, then sleep on a futex
+ */
+template<class T>
+class BlockingMpmcQueue
+{
+    /**
+     * Futex word bumped on every change, and the number of its sleepers
+     */
+    struct alignas(64) Waiters
+    {
+        std::atomic<uint32_t> epoch{ 0 };
+        std::atomic<uint32_t> sleepers{ 0 };
+    };
+
+    MpmcRingBuffer<T> queue;
+
+    // Producers waiting for a free cell, consumers waiting for an element
+    Waiters not_full;
+    Waiters not_empty;
+
+public:
+    // Constructor
+    BlockingMpmcQueue(size_t capacity) : queue(capacity) {}
+
+    // Enqueue new element to the Queue, waiting while it is full
+    void push(const T& element)
+    {
+        wait_for(not_full, [&]() { return queue.try_push(element); });
+        wake(not_empty);
+    }
+
+    // Dequeue the element from Queue, waiting while it is empty
+    T pop()
+    {
+        T element;
+        wait_for(not_empty, [&]() { return queue.try_pop(element); });
+        wake(not_full);
+        return element;
+    }
+
+private:
+    // Retry the operation until it succeeds, backing off in three stages
+    template<class Operation>
+    void wait_for(Waiters& waiters, Operation operation);
+
+    // Wake a sleeper after the queue changed, if any
+    void wake(Waiters& waiters);
+};
+
+template<class T>
+template<class Operation>
+void BlockingMpmcQueue<T>::wait_for(Waiters& waiters, Operation operation)
+{
+    // Stage 1. Spin, for the other side on another core to catch up
+    for (int i=0; i < SPIN_LIMIT; i++) {
+        if (operation()) {
+            return;
+        }
+        cpu_relax();
+    }
+
+    // Stage 2. Yield, letting the other side run on this core
+    for (int i=0; i < YIELD_LIMIT; i++) {
+        if (operation()) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    // Stage 3. Sleep until the epoch changes. The sleeper is counted and
+    // the epoch read before the last retry, so a change after the retry
+    // either makes the waker see the sleeper or makes futex_wait return.
+    for (;;) {
+        waiters.sleepers.fetch_add(1);
+        uint32_t epoch = waiters.epoch.load();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (operation()) {
+            waiters.sleepers.fetch_sub(1);
+            return;
+        }
+        futex_wait(waiters.epoch, epoch);
+        waiters.sleepers.fetch_sub(1);
+        if (operation()) {
+            return;
+        }
+    }
+}
+
+template<class T>
+void BlockingMpmcQueue<T>::wake(Waiters& waiters)
+{
+    // Order the queue change before reading the sleepers, pairing with the
+    // sleeper's count before its retry
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.sleepers.load(std::memory_order_relaxed) > 0) {
+        waiters.epoch.fetch_add(1);
+        futex_wake(waiters.epoch);
+    }
+}
+
+// Move count messages from producers to consumers through the blocking queue
+// Returns the throughput in messages per second
+long long run(int producers, int consumers, int count)
+{
+    BlockingMpmcQueue<int> queue(1024);
+    std::atomic<long long> checksum(0);
+
+    auto start = chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int p=0; p < producers; p++) {
+        pool.push_back(std::thread([&, p]() {
+            for (int i=p; i < count; i += producers) {
+                queue.push(i);
+            }
+        }));
+    }
+    for (int c=0; c < consumers; c++) {
+        pool.push_back(std::thread([&, c]() {
+            long long sum = 0;
+            for (int i=c; i < count; i += consumers) {
+                sum += queue.pop();
+            }
+            checksum += sum;
+        }));
+    }
+    for (size_t t=0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    if (checksum != (long long)(count - 1) * count / 2) {
+        cout << "checksum mismatch" << endl;
+    }
+    return (long long)(count / ms * 1000);
+}
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Queue of 8 cells
+    MpmcRingBuffer<int> queue(8);
+
+    // Enqueue elements (10, 20, 30, 40, and 50)
+    queue.try_push(10);
+    queue.try_push(20);
+    queue.try_push(30);
+    queue.try_push(40);
+    queue.try_push(50);
+    queue.display("Queue after inserting 10 20 30 40 and 50");
+
+    // Dequeue the elements from Queue
+    int element;
+    queue.try_pop(element);
+    cout << "Dequeue element returned " << element << endl;
+    queue.try_pop(element);
+    cout << "Dequeue element returned " << element << endl;
+    queue.display("Queue after removing 10 and 20");
+
+    // Enqueue elements (60, 70, 80, 90 and 100) across the wrap point
+    for (int value=60; value <= 100; value += 10) {
+        if (!queue.try_push(value)) {
+            cout << "Queue is Full, " << value << " not inserted" << endl;
+        }
+    }
+    queue.display("Queue after inserting 60, 70, 80, 90 and 100");
+
+    // Producer/consumer matrix through the blocking queue
+    const int count = 1 << 21;
+    cout << endl << "Messages per second, " << count << " messages per cell, "
+         << std::thread::hardware_concurrency() << " cores available" << endl;
+    cout << "PRODUCERS \\ CONSUMERS";
+    for (int consumers=1; consumers <= 16; consumers *= 2) {
+        cout.width(11);
+        cout << consumers;
+    }
+    cout << endl;
+    for (int producers=1; producers <= 16; producers *= 2) {
+        cout.width(21);
+        cout << producers;
+        for (int consumers=1; consumers <= 16; consumers *= 2) {
+            cout.width(11);
+            cout << run(producers, consumers, count);
+        }
+        cout << endl;
+    }
+}
@@ -0,0 +1,502 @@
+/**
+ * C++ example to demonstrate a Queue shared between processes
+ *
+ * The circular array queue placed in a POSIX shared memory segment
+ * (shm_open + mmap), so a producer process and a consumer process on the
+ * same host exchange messages without a socket or a system call per
+ * message:
+ *
+ * - The segment starts with a header holding only sizes and byte
+ *   positions, never pointers, so each process may map it anywhere.
+ * - Messages are variable-length records framed by an 8-byte header with
+ *   their length, padded to 8 bytes. A record which does not fit before
+ *   the end of the ring is preceded by a wrap marker and written from the
+ *   start of the ring, so every record is contiguous.
+ * - Head and tail are byte positions which only grow, read and written
+ *   with acquire/release atomics, as in spsc_ring_buffer.cpp. There is one
+ *   producer and one consumer.
+ * - A consumer finding the queue empty spins briefly, then sleeps on a
+ *   futex word in the segment. The producer only makes the wake-up system
+ *   call when the consumer announced it sleeps. The same holds for a
+ *   producer finding the queue full.
+ *
+ * Futexes and shm_open are Linux specific here.
+ *
+ * Compile with: g++ -std=c++17 -O2 shared_memory_queue.cpp -lrt
+ */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <linux/futex.h>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+using namespace std;
+
+// Identifies an initialized segment
+#define QUEUE_MAGIC 0x51554555
+
+// Length marking the rest of the ring as unused, the next record being
+// at the start of the ring
+#define WRAP_MARKER 0xFFFFFFFF
+
+// Size of a record header, and the alignment of records
+#define RECORD_ALIGN 8
+
+// Number of checks an idle side makes before sleeping
+#define SPIN_LIMIT 256
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock-free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared atomics must be lock-free");
+
+/**
+ * Futex word bumped on every change, and whether a process sleeps on it
+ */
+struct alignas(64) SharedWaiter
+{
+    std::atomic<uint32_t> epoch;
+    std::atomic<uint32_t> sleeping;
+};
+
+/**
+ * Segment header, followed by the ring of records
+ */
+struct SharedHeader
+{
+    uint32_t magic;
+    uint32_t header_size;
+    uint64_t capacity; // Bytes in the ring, a power of two
+
+    // Next byte to read, written by the consumer
+    alignas(64) std::atomic<uint64_t> head;
+
+    // Next byte to write, written by the producer
+    alignas(64) std::atomic<uint64_t> tail;
+
+    // Consumer waiting for records, producer waiting for room
+    SharedWaiter not_empty;
+    SharedWaiter not_full;
+};
+
+/**
+ * Interprocess Queue implementation using a shared Ring Buffer
+ */
+class SharedMemoryQueue
+{
+    // Mapping of the segment
+    SharedHeader* header;
+    unsigned char* ring;
+    size_t mapped;
+    uint64_t mask;
+
+public:
+    // Create the named segment with a ring of at least capacity bytes
+    // Throws runtime_error if the segment cannot be created
+    SharedMemoryQueue(const std::string& name, size_t capacity);
+
+    // Open the named segment created by another process
+    // Throws runtime_error if the segment cannot be opened
+    SharedMemoryQueue(const std::string& name);
+
+    // Destructor, unmapping the segment
+    ~SharedMemoryQueue() { munmap(header, mapped); }
+
+    // Remove the named segment, once both processes have opened it
+    static void unlink(const std::string& name) { shm_unlink(name.c_str()); }
+
+    // Returns the largest record the ring accepts
+    size_t max_record() const { return header->capacity / 2 - RECORD_ALIGN; }
+
+    // Enqueue a record, producer only
+    // Returns false if the ring has no room for it.
+    // Throws runtime_error if the record is larger than max_record().
+    bool try_write(const void* data, uint32_t length);
+
+    // Enqueue a record, sleeping while the ring has no room, producer only
+    void write(const void* data, uint32_t length);
+
+    // Dequeue a record into the vector, consumer only
+    // Returns false if the queue is empty.
+    bool try_read(std::vector<unsigned char>& record);
+
+    // Dequeue a record, sleeping while the queue is empty, consumer only
+    void read(std::vector<unsigned char>& record);
+
+private:
+    SharedMemoryQueue(const SharedMemoryQueue&);
+    SharedMemoryQueue& operator=(const SharedMemoryQueue&);
+
+    // Map the segment of the open descriptor
+    void map(int fd, size_t size);
+
+    // Returns the byte size of a record with its header and padding
+    static uint64_t frame_size(uint32_t length) { return (RECORD_ALIGN + length + RECORD_ALIGN - 1) & ~(uint64_t)(RECORD_ALIGN - 1); }
+};
+
+// Sleep while the shared futex word holds the expected value
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, NULL, NULL, 0);
+}
+
+// Wake the process sleeping on the shared futex word
+void futex_wake(std::atomic<uint32_t>& word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+// Retry the operation until it succeeds, spinning then sleeping
+template<class Operation>
+void wait_for(SharedWaiter& waiter, Operation operation)
+{
+    for (int i=0; i < SPIN_LIMIT; i++) {
+        if (operation()) {
+            return;
+        }
+    }
+    for (;;) {
+        // Announce the sleep and read the epoch before the last retry, so
+        // a change after the retry either bumps the epoch or sees the flag
+        waiter.sleeping.store(1);
+        uint32_t epoch = waiter.epoch.load();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (operation()) {
+            waiter.sleeping.store(0, std::memory_order_relaxed);
+            return;
+        }
+        futex_wait(waiter.epoch, epoch);
+        waiter.sleeping.store(0, std::memory_order_relaxed);
+        if (operation()) {
+            return;
+        }
+    }
+}
+
+// Wake the other side after a change, if it sleeps. The flag is cleared
+// here, so the changes made before the sleeper runs again do not each
+// make a system call.
+void wake(SharedWaiter& waiter)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiter.sleeping.load(std::memory_order_relaxed) != 0 && waiter.sleeping.exchange(0) != 0) {
+        waiter.epoch.fetch_add(1);
+        futex_wake(waiter.epoch);
+    }
+}
+
+SharedMemoryQueue::SharedMemoryQueue(const std::string& name, size_t capacity)
+{
+    // Step 1. Round the ring up to a power of two
+    uint64_t ring_size = 4096;
+    while (ring_size < capacity) {
+        ring_size *= 2;
+    }
+    size_t header_size = (sizeof(SharedHeader) + 63) & ~(size_t)63;
+
+    // Step 2. Create and size the segment
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open " + name + ": " + strerror(errno));
+    }
+    if (ftruncate(fd, header_size + ring_size) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("ftruncate " + name + ": " + strerror(errno));
+    }
+    map(fd, header_size + ring_size);
+
+    // Step 3. Initialize the header, the magic last
+    new (header) SharedHeader();
+    header->header_size = (uint32_t)header_size;
+    header->capacity = ring_size;
+    header->head.store(0);
+    header->tail.store(0);
+    header->not_empty.epoch.store(0);
+    header->not_empty.sleeping.store(0);
+    header->not_full.epoch.store(0);
+    header->not_full.sleeping.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = QUEUE_MAGIC;
+    ring = reinterpret_cast<unsigned char*>(header) + header_size;
+    mask = ring_size - 1;
+}
+
+SharedMemoryQueue::SharedMemoryQueue(const std::string& name)
+{
+    // Step 1. Open the segment and map all of it
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open " + name + ": " + strerror(errno));
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SharedHeader)) {
+        close(fd);
+        throw std::runtime_error("segment " + name + " is too small");
+    }
+    map(fd, info.st_size);
+
+    // Step 2. Check the header, which gives the position of the ring
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->magic != QUEUE_MAGIC || header->header_size + header->capacity != mapped) {
+        munmap(header, mapped);
+        throw std::runtime_error("segment " + name + " is not a queue");
+    }
+    ring = reinterpret_cast<unsigned char*>(header) + header->header_size;
+    mask = header->capacity - 1;
+}
+
+void SharedMemoryQueue::map(int fd, size_t size)
+{
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error(std::string("mmap: ") + strerror(errno));
+    }
+    header = static_cast<SharedHeader*>(base);
+    mapped = size;
+}
+
+bool SharedMemoryQueue::try_write(const void* data, uint32_t length)
+{
+    if (length > max_record()) {
+        throw std::runtime_error("record too large");
+    }
+
+    // Step 1. Find the room needed, including the skipped end of the ring
+    // if the record does not fit before it
+    uint64_t tail = header->tail.load(std::memory_order_relaxed);
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    uint64_t frame = frame_size(length);
+    uint64_t offset = tail & mask;
+    uint64_t skip = header->capacity - offset < frame ? header->capacity - offset : 0;
+    if (tail + skip + frame - head > header->capacity) {
+        return false;
+    }
+
+    // Step 2. Mark the skipped end of the ring
+    if (skip > 0) {
+        uint32_t marker = WRAP_MARKER;
+        std::memcpy(ring + offset, &marker, sizeof(marker));
+        offset = 0;
+    }
+
+    // Step 3. Write the frame, then publish it by moving the tail
+    std::memcpy(ring + offset, &length, sizeof(length));
+    std::memcpy(ring + offset + RECORD_ALIGN, data, length);
+    header->tail.store(tail + skip + frame, std::memory_order_release);
+    wake(header->not_empty);
+    return true;
+}
+
+bool SharedMemoryQueue::try_read(std::vector<unsigned char>& record)
+{
+    // Step 1. Return if the Queue is empty
+    uint64_t head = header->head.load(std::memory_order_relaxed);
+    uint64_t tail = header->tail.load(std::memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+
+    // Step 2. Skip to the start of the ring at a wrap marker
+    uint64_t offset = head & mask;
+    uint32_t length;
+    std::memcpy(&length, ring + offset, sizeof(length));
+    if (length == WRAP_MARKER) {
+        head += header->capacity - offset;
+        offset = 0;
+        std::memcpy(&length, ring, sizeof(length));
+    }
+
+    // Step 3. Copy the record out, then release its frame
+    record.assign(ring + offset + RECORD_ALIGN, ring + offset + RECORD_ALIGN + length);
+    header->head.store(head + frame_size(length), std::memory_order_release);
+    wake(header->not_full);
+    return true;
+}
+
+void SharedMemoryQueue::write(const void* data, uint32_t length)
+{
+    wait_for(header->not_full, [&]() { return try_write(data, length); });
+}
+
+void SharedMemoryQueue::read(std::vector<unsigned char>& record)
+{
+    wait_for(header->not_empty, [&]() { return try_read(record); });
+}
+
+/**
+ * Benchmark message: send time, sequence number, then padding
+ */
+struct Message
+{
+    int64_t sent_ns;
+    uint64_t sequence;
+};
+
+// Returns the monotonic clock in nanoseconds, the same in both processes
+int64_t now_ns()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Print the throughput and the latency percentiles seen by the consumer
+void report(const char* transport, size_t size, std::vector<int64_t>& latencies, int64_t first_sent, int64_t last_received)
+{
+    std::sort(latencies.begin(), latencies.end());
+    size_t n = latencies.size();
+    double seconds = (last_received - first_sent) / 1e9;
+    cout.width(8);
+    cout << transport << " | ";
+    cout.width(5);
+    cout << size << " | ";
+    cout.width(11);
+    cout << (long long)(n / seconds) << " | ";
+    cout.width(7);
+    cout << latencies[n / 2] / 1000.0 << " | ";
+    cout.width(7);
+    cout << latencies[n * 99 / 100] / 1000.0 << " | ";
+    cout.width(8);
+    cout << latencies[n * 999 / 1000] / 1000.0 << endl;
+}
+
+// Send count messages of the given size from a parent process to a child
+// process, pausing pause_ns between messages, through the shared queue or
+// through a Unix socket pair. The child prints the results.
+void run(bool shared, size_t size, int count, int64_t pause_ns)
+{
+    std::string name = "/queue-benchmark-" + std::to_string(getpid());
+    SharedMemoryQueue* queue = NULL;
+    int sockets[2] = { -1, -1 };
+    if (shared) {
+        queue = new SharedMemoryQueue(name, 1 << 20);
+    } else if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0) {
+        throw std::runtime_error(std::string("socketpair: ") + strerror(errno));
+    }
+    cout.flush();
+
+    pid_t child = fork();
+    if (child == 0) {
+        // Consumer: open the queue by name, as an unrelated process would
+        SharedMemoryQueue* consumer = shared ? new SharedMemoryQueue(name) : NULL;
+        std::vector<unsigned char> record(size);
+        std::vector<int64_t> latencies;
+        latencies.reserve(count);
+        int64_t first_sent = 0;
+        for (int i=0; i < count; i++) {
+            if (shared) {
+                consumer->read(record);
+            } else {
+                record.resize(size);
+                record.resize(recv(sockets[1], record.data(), size, 0));
+            }
+            Message message;
+            std::memcpy(&message, record.data(), sizeof(message));
+            if (message.sequence != (uint64_t)i) {
+                cout << "message " << i << " out of order" << endl;
+                _exit(1);
+            }
+            if (i == 0) {
+                first_sent = message.sent_ns;
+            }
+            latencies.push_back(now_ns() - message.sent_ns);
+        }
+        report(shared ? "shm" : "socket", size, latencies, first_sent, now_ns());
+        delete consumer;
+        _exit(0);
+    }
+
+    // Producer
+    std::vector<unsigned char> record(size);
+    for (int i=0; i < count; i++) {
+        if (pause_ns > 0) {
+            int64_t until = now_ns() + pause_ns;
+            while (now_ns() < until) {
+            }
+        }
+        Message message = { now_ns(), (uint64_t)i };
+        std::memcpy(record.data(), &message, sizeof(message));
+        if (shared) {
+            queue->write(record.data(), (uint32_t)size);
+        } else {
+            send(sockets[0], record.data(), size, 0);
+        }
+    }
+    waitpid(child, NULL, 0);
+
+    if (shared) {
+        SharedMemoryQueue::unlink(name);
+        delete queue;
+    } else {
+        close(sockets[0]);
+        close(sockets[1]);
+    }
+}
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Queue, and open it a second time as the consumer
+    std::string name = "/queue-demo-" + std::to_string(getpid());
+    SharedMemoryQueue producer(name, 4096);
+    SharedMemoryQueue consumer(name);
+    SharedMemoryQueue::unlink(name);
+
+    // Enqueue records of different lengths
+    const char* words[] = { "ten", "twenty", "thirty", "forty" };
+    for (const char* word : words) {
+        producer.write(word, (uint32_t)strlen(word));
+    }
+
+    // Dequeue them through the second mapping
+    std::vector<unsigned char> record;
+    while (consumer.try_read(record)) {
+        cout << "Dequeue record returned \"" << std::string(record.begin(), record.end())
+             << "\" (" << record.size() << " bytes)" << endl;
+    }
+
+    // Records of 1000 bytes wrap around the 4 KiB ring
+    std::vector<unsigned char> big(1000, 'x');
+    for (int i=0; i < 10; i++) {
+        big[0] = (unsigned char)('0' + i);
+        producer.write(big.data(), (uint32_t)big.size());
+        consumer.read(record);
+        if (record.size() != 1000 || record[0] != '0' + i) {
+            cout << "Wrapped record " << i << " is damaged" << endl;
+        }
+    }
+    cout << "10 records of 1000 bytes passed around the 4 KiB ring" << endl;
+
+    try {
+        std::vector<unsigned char> huge(4096);
+        producer.try_write(huge.data(), (uint32_t)huge.size());
+    } catch (const std::exception& e) {
+        cout << "Write: exception received: " << e.what() << endl;
+    }
+
+    // Benchmark between two processes: as fast as possible, then one
+    // message every 20 microseconds so the consumer sleeps between them
+    cout << endl << "Flat out, 1M messages (latency includes queueing)" << endl;
+    cout << "   QUEUE |  SIZE |     MSG/SEC | P50 US  | P99 US  | P999 US" << endl;
+    cout << "---------+-------+-------------+---------+---------+---------" << endl;
+    for (size_t size=16; size <= 1024; size *= 8) {
+        run(true, size, 1000000, 0);
+        run(false, size, 1000000, 0);
+    }
+    cout << endl << "Paced, 20000 messages 20 us apart" << endl;
+    cout << "   QUEUE |  SIZE |     MSG/SEC | P50 US  | P99 US  | P999 US" << endl;
+    cout << "---------+-------+-------------+---------+---------+---------" << endl;
+    run(true, 64, 20000, 20000);
+    run(false, 64, 20000, 20000);
+}
@@ -0,0 +1,374 @@
+/**
+ * C++ example to demonstrate a Single-Producer Single-Consumer Ring Buffer
+ *
+ * The circular queue of circular_queue_using_array.cpp, made safe for one
+ * producer thread and one consumer thread without locks:
+ *
+ * - Head and tail are counters which only grow. The slot of a position is
+ *   position & mask with a power-of-two capacity, the queue is empty when
+ *   head == tail and full when tail - head == capacity, so no -1 sentinels
+ *   and no % are needed.
+ * - Only the producer writes the tail and only the consumer writes the
+ *   head. A release store of the tail publishes the element written before
+ *   it, and an acquire load by the consumer sees it, and the same the other
+ *   way for free slots. Every operation is a bounded number of steps, so
+ *   the queue is wait-free.
+ * - Head and tail live on separate cache lines, so the two threads do not
+ *   invalidate each other's line on every operation.
+ * - Each side keeps a cached copy of the other side's counter and rereads
+ *   the shared one only when the cached copy says full (or empty), which
+ *   avoids pulling the other core's cache line on most operations.
+ *
+ * Compile with: g++ -std=c++17 -O2 -pthread spsc_ring_buffer.cpp
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <thread>
+using namespace std;
+
+/**
+ * SPSC Ring Buffer implementation using Array
+ */
+template<class T>
+class SpscRingBuffer
+{
+    // Written by the consumer: next position to read, and its copy of tail
+    alignas(64) std::atomic<size_t> head;
+    size_t cached_tail;
+
+    // Written by the producer: next position to write, and its copy of head
+    alignas(64) std::atomic<size_t> tail;
+    size_t cached_head;
+
+    // Read only: the slots and capacity - 1
+    alignas(64) T* buffer;
+    size_t mask;
+
+public:
+    // Constructor, rounding the capacity up to a power of two
+    SpscRingBuffer(size_t capacity);
+
+    // Destructor
+    ~SpscRingBuffer() { delete[] buffer; }
+
+    // Returns the number of slots
+    size_t capacity() const { return mask + 1; }
+
+    // Enqueue new element to the Queue, producer only
+    // Returns false if the queue is full.
+    bool try_push(const T& element)
+    {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if (position - cached_head == capacity()) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (position - cached_head == capacity()) {
+                return false;
+            }
+        }
+        buffer[position & mask] = element;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Dequeue the element from Queue, consumer only
+    // Returns false if the queue is empty.
+    bool try_pop(T& element)
+    {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (position == cached_tail) {
+                return false;
+            }
+        }
+        element = buffer[position & mask];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Enqueue up to n elements, producer only
+    // Returns the number of elements enqueued, less than n if the queue fills.
+    size_t try_push_n(const T* values, size_t n);
+
+    // Dequeue up to n elements into out, consumer only
+    // Returns the number of elements dequeued, less than n if the queue empties.
+    size_t try_pop_n(T* out, size_t n);
+
+    // Print the Queue, only while no other thread uses it
+    void display(const std::string& msg);
+
+private:
+    SpscRingBuffer(const SpscRingBuffer&);
+    SpscRingBuffer& operator=(const SpscRingBuffer&);
+};
+
+template<class T>
+SpscRingBuffer<T>::SpscRingBuffer(size_t capacity) : head(0), cached_tail(0), tail(0), cached_head(0)
+{
+    size_t slots = 1;
+    while (slots < capacity) {
+        slots *= 2;
+    }
+    buffer = new T[slots]();
+    mask = slots - 1;
+}
+
+template<class T>
+size_t SpscRingBuffer<T>::try_push_n(const T* values, size_t n)
+{
+    // Step 1. Count the free slots, rereading head only if short of room
+    size_t position = tail.load(std::memory_order_relaxed);
+    if (capacity() - (position - cached_head) < n) {
+        cached_head = head.load(std::memory_order_acquire);
+    }
+    n = std::min(n, capacity() - (position - cached_head));
+
+    // Step 2. Copy up to the end of the array, then the rest from its start
+    size_t start = position & mask;
+    size_t first = std::min(n, capacity() - start);
+    std::copy(values, values + first, buffer + start);
+    std::copy(values + first, values + n, buffer);
+
+    // Step 3. Publish all of them at once
+    tail.store(position + n, std::memory_order_release);
+    return n;
+}
+
+template<class T>
+size_t SpscRingBuffer<T>::try_pop_n(T* out, size_t n)
+{
+    // Step 1. Count the available elements, rereading tail only if short
+    size_t position = head.load(std::memory_order_relaxed);
+    if (cached_tail - position < n) {
+        cached_tail = tail.load(std::memory_order_acquire);
+    }
+    n = std::min(n, cached_tail - position);
+
+    // Step 2. Copy up to the end of the array, then the rest from its start
+    size_t start = position & mask;
+    size_t first = std::min(n, capacity() - start);
+    std::copy(buffer + start, buffer + start + first, out);
+    std::copy(buffer, buffer + (n - first), out + first);
+
+    // Step 3. Release the slots at once
+    head.store(position + n, std::memory_order_release);
+    return n;
+}
+
+template<class T>
+void SpscRingBuffer<T>::display(const std::string& msg)
+{
+    cout << msg << endl;
+    size_t front = head.load();
+    size_t rear = tail.load();
+    if (front == rear) {
+        cout << "Queue is Empty" << endl;
+        return;
+    }
+
+    cout << "IDX ELEMENT" << endl;
+    cout << "---+-------" << endl;
+    for (size_t position=front; position != rear; position++) {
+        cout << "[" << (position & mask) << "] " << buffer[position & mask];
+        if (position == front) {
+            cout << " <-- front";
+        }
+        if (position == rear - 1) {
+            cout << (position == front ? ", rear" : " <-- rear");
+        }
+        cout << endl;
+    }
+}
+
+// Circular Queue using Array behind one mutex, used for comparison
+class MutexCircularQueue
+{
+    std::mutex lock;
+    int* queue;
+    size_t capacity;
+    size_t front = 0;
+    size_t count = 0;
+
+public:
+    MutexCircularQueue(size_t capacity) : queue(new int[capacity]), capacity(capacity) {}
+    ~MutexCircularQueue() { delete[] queue; }
+
+    bool try_push(int element)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (count == capacity) {
+            return false;
+        }
+        queue[(front + count++) % capacity] = element;
+        return true;
+    }
+
+    bool try_pop(int& element)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (count == 0) {
+            return false;
+        }
+        element = queue[front];
+        front = (front + 1) % capacity;
+        count--;
+        return true;
+    }
+
+    size_t try_push_n(const int* values, size_t n)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        n = std::min(n, capacity - count);
+        for (size_t i=0; i < n; i++) {
+            queue[(front + count++) % capacity] = values[i];
+        }
+        return n;
+    }
+
+    size_t try_pop_n(int* out, size_t n)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        n = std::min(n, count);
+        for (size_t i=0; i < n; i++) {
+            out[i] = queue[front];
+            front = (front + 1) % capacity;
+        }
+        count -= n;
+        return n;
+    }
+};
+
+// Pin the calling thread to a core, modulo the number of cores
+// Does nothing if the number of cores is unknown.
+void pin_to_core(int core)
+{
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores == 0) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % cores, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// Move count messages from a producer pinned to core 0 to a consumer
+// pinned to core 1, one at a time, or in batches if batch > 1
+// Returns the throughput in messages per second
+template<class QueueType>
+long long run(QueueType& queue, long long count, size_t batch)
+{
+    long long sum = 0;
+    auto start = chrono::steady_clock::now();
+
+    std::thread consumer([&]() {
+        pin_to_core(1);
+        int values[256];
+        long long received = 0;
+        while (received < count) {
+            size_t n = 0;
+            if (batch > 1) {
+                n = queue.try_pop_n(values, batch);
+            } else if (queue.try_pop(values[0])) {
+                n = 1;
+            }
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            for (size_t i=0; i < n; i++) {
+                sum += values[i];
+            }
+            received += n;
+        }
+    });
+
+    pin_to_core(0);
+    int values[256];
+    for (long long sent=0; sent < count; ) {
+        size_t n = 0;
+        if (batch > 1) {
+            for (size_t i=0; i < batch; i++) {
+                values[i] = (int)(sent + i);
+            }
+            n = queue.try_push_n(values, std::min((long long)batch, count - sent));
+        } else if (queue.try_push((int)sent)) {
+            n = 1;
+        }
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+        sent += n;
+    }
+    consumer.join();
+
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    if (sum != (count - 1) * count / 2) {
+        cout << "checksum mismatch" << endl;
+    }
+    return (long long)(count / ms * 1000);
+}
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Queue of 8 slots
+    SpscRingBuffer<int> queue(8);
+
+    // Enqueue elements (10, 20, 30, 40, and 50)
+    queue.try_push(10);
+    queue.try_push(20);
+    queue.try_push(30);
+    queue.try_push(40);
+    queue.try_push(50);
+    queue.display("Queue after inserting 10 20 30 40 and 50");
+
+    // Dequeue the elements from Queue
+    int element;
+    queue.try_pop(element);
+    cout << "Dequeue element returned " << element << endl;
+    queue.try_pop(element);
+    cout << "Dequeue element returned " << element << endl;
+    queue.display("Queue after removing 10 and 20");
+
+    // Enqueue elements (60, 70, 80, 90, 100 and 110) across the wrap point,
+    // the last one not fitting
+    int values[] = { 60, 70, 80, 90, 100, 110 };
+    size_t n = queue.try_push_n(values, 6);
+    cout << "try_push_n of 6 elements enqueued " << n << endl;
+    queue.display("Queue after inserting 60, 70, 80, 90 and 100");
+
+    int out[8];
+    n = queue.try_pop_n(out, 8);
+    cout << "try_pop_n of 8 elements dequeued " << n << ":";
+    for (size_t i=0; i < n; i++) {
+        cout << " " << out[i];
+    }
+    cout << endl;
+
+    // Benchmark, 20M messages between two pinned threads
+    const long long count = 20000000;
+    cout << endl << "Cores available: " << std::thread::hardware_concurrency() << endl;
+    cout << " CAPACITY | MUTEX MSG/SEC | SPSC MSG/SEC | SPSC BATCH 64 MSG/SEC" << endl;
+    cout << "----------+---------------+--------------+----------------------" << endl;
+    for (size_t capacity=1024; capacity <= 65536; capacity *= 64) {
+        MutexCircularQueue mutex_queue(capacity);
+        SpscRingBuffer<int> single(capacity);
+        SpscRingBuffer<int> batched(capacity);
+        long long mutex_rate = run(mutex_queue, count / 4, 1);
+        long long single_rate = run(single, count, 1);
+        long long batch_rate = run(batched, count, 64);
+        cout.width(9);
+        cout << capacity << " | ";
+        cout.width(13);
+        cout << mutex_rate << " | ";
+        cout.width(12);
+        cout << single_rate << " | ";
+        cout.width(20);
+        cout << batch_rate << endl;
+    }
+}
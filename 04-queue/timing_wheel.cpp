@@ -0,0 +1,521 @@
+/**
+ * C++ example to demonstrate the Hierarchical Timing Wheel
+ *
+ * A timing wheel is a priority queue specialised for timeouts. Time is
+ * counted in ticks, and the wheel of each level is an array of slots,
+ * each slot being a circular doubly linked ring of the timers due in it.
+ * Level 0 has one slot per tick, level 1 one slot per 256 ticks, and so
+ * on. A timer goes to the lowest level whose range covers its delay, and
+ * when the time reaches the start of a slot of a higher level, the timers
+ * of that slot cascade down to the levels below (Varghese and Lauck).
+ *
+ * The timers are intrusive: the caller owns the Timer memory and the wheel
+ * only links it, so schedule() and cancel() are O(1) and never allocate.
+ *
+ * Compile with: g++ -std=c++17 -O2 timing_wheel.cpp
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <vector>
+using namespace std;
+
+// Number of bits of the time used by each level
+#define LEVEL_BITS 8
+
+// Number of slots per level
+#define SLOTS (1 << LEVEL_BITS)
+
+// Number of levels, covering delays up to 2^32 ticks
+#define LEVELS 4
+
+/**
+ * Timer representation
+ * Embed it in the object to be notified and recover the object in the callback.
+ */
+struct Timer
+{
+    Timer* prev;                   // Previous timer on the slot ring, NULL if not scheduled
+    Timer* next;                   // Next timer on the slot ring, NULL if not scheduled
+    uint64_t expires;              // Tick at which the timer fires
+    void (*callback)(Timer* self); // Called when the timer fires
+};
+
+/**
+ * Hierarchical timing wheel implementation
+ */
+class TimingWheel
+{
+    // Slot rings, each headed by a sentinel timer linked to itself when empty
+    Timer slots[LEVELS][SLOTS];
+
+    // Current tick
+    uint64_t now;
+
+    // Number of scheduled timers
+    size_t count;
+
+public:
+    // Constructor
+    TimingWheel();
+
+    // Schedule the timer to fire at the given tick
+    // A tick which is not in the future fires at the next tick. A scheduled
+    // timer is moved to the new tick.
+    void schedule(Timer* timer, uint64_t expires);
+
+    // Cancel the timer
+    // Returns true if it was scheduled, false otherwise.
+    bool cancel(Timer* timer);
+
+    // Check if the timer is scheduled
+    bool is_pending(const Timer* timer) const { return timer->next != NULL; }
+
+    // Move the time forward by the given number of ticks and fire the timers
+    // which expire, all the timers of a tick in one batch
+    // Returns the number of timers fired.
+    size_t advance(uint64_t ticks);
+
+    // Returns the current tick
+    uint64_t time() const { return now; }
+
+    // Returns the number of scheduled timers
+    size_t size() const { return count; }
+
+    // Print the non-empty slots
+    void display(const std::string& msg) const;
+
+private:
+    // Link the timer into the slot matching its expiry
+    void place(Timer* timer);
+
+    // Re-place all the timers of a higher level slot into the lower levels
+    void cascade(int level, int index);
+
+    // Link the timer at the end of the ring
+    static void link(Timer* ring, Timer* timer);
+
+    // Unlink the timer from its ring
+    static void unlink(Timer* timer);
+};
+
+TimingWheel::TimingWheel() : now(0), count(0)
+{
+    for (int l=0; l < LEVELS; l++) {
+        for (int s=0; s < SLOTS; s++) {
+            slots[l][s].prev = &slots[l][s];
+            slots[l][s].next = &slots[l][s];
+        }
+    }
+}
+
+void TimingWheel::link(Timer* ring, Timer* timer)
+{
+    timer->prev = ring->prev;
+    timer->next = ring;
+    ring->prev->next = timer;
+    ring->prev = timer;
+}
+
+void TimingWheel::unlink(Timer* timer)
+{
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->prev = NULL;
+    timer->next = NULL;
+}
+
+void TimingWheel::place(Timer* timer)
+{
+    // Step 1. Find the lowest level whose range covers the delay.
+    // A delay of 0 only happens while cascading, it goes to the slot about to fire.
+    uint64_t delay = timer->expires - now;
+    for (int l=0; l < LEVELS; l++) {
+        if (delay < ((uint64_t)1 << (LEVEL_BITS * (l + 1)))) {
+            int index = (timer->expires >> (LEVEL_BITS * l)) & (SLOTS - 1);
+            link(&slots[l][index], timer);
+            return;
+        }
+    }
+
+    // Step 2. Beyond the top level, wait in the top slot visited last.
+    // The timer is placed again when that slot cascades.
+    int top = LEVELS - 1;
+    int index = ((now >> (LEVEL_BITS * top)) - 1) & (SLOTS - 1);
+    link(&slots[top][index], timer);
+}
+
+void TimingWheel::schedule(Timer* timer, uint64_t expires)
+{
+    // Step 1. Unlink the timer if it is already scheduled
+    if (is_pending(timer)) {
+        unlink(timer);
+        count--;
+    }
+
+    // Step 2. Link it into its slot
+    timer->expires = std::max(expires, now + 1);
+    place(timer);
+    count++;
+}
+
+bool TimingWheel::cancel(Timer* timer)
+{
+    if (!is_pending(timer)) {
+        return false;
+    }
+    unlink(timer);
+    count--;
+    return true;
+}
+
+void TimingWheel::cascade(int level, int index)
+{
+    // Step 1. Detach the whole ring from the slot in O(1)
+    Timer* ring = &slots[level][index];
+    if (ring->next == ring) {
+        return;
+    }
+    Timer* first = ring->next;
+    Timer* last = ring->prev;
+    ring->prev = ring;
+    ring->next = ring;
+    last->next = NULL;
+
+    // Step 2. Place every timer again, now that the time is closer
+    while (first != NULL) {
+        Timer* timer = first;
+        first = first->next;
+        place(timer);
+    }
+}
+
+size_t TimingWheel::advance(uint64_t ticks)
+{
+    size_t fired = 0;
+    for (uint64_t t=0; t < ticks; t++) {
+        now++;
+
+        // Step 1. At the start of a level 1 slot, cascade it down. At the
+        // start of a level 2 slot as well, cascade that one too, and so on.
+        int index = now & (SLOTS - 1);
+        for (int l=1; l < LEVELS && index == 0; l++) {
+            index = (now >> (LEVEL_BITS * l)) & (SLOTS - 1);
+            cascade(l, index);
+        }
+
+        // Step 2. Move the ring of this tick onto a local sentinel in O(1),
+        // so that callbacks can schedule timers into the slot again
+        Timer* ring = &slots[0][now & (SLOTS - 1)];
+        if (ring->next == ring) {
+            continue;
+        }
+        Timer batch;
+        batch.next = ring->next;
+        batch.prev = ring->prev;
+        batch.next->prev = &batch;
+        batch.prev->next = &batch;
+        ring->prev = ring;
+        ring->next = ring;
+
+        // Step 3. Fire the batch. A callback may cancel or reschedule a timer
+        // of the batch which has not fired yet.
+        while (batch.next != &batch) {
+            Timer* timer = batch.next;
+            unlink(timer);
+            count--;
+            fired++;
+            timer->callback(timer);
+        }
+    }
+    return fired;
+}
+
+void TimingWheel::display(const std::string& msg) const
+{
+    cout << msg << endl;
+    cout << "now = " << now << ", " << count << " timers" << endl;
+    for (int l=0; l < LEVELS; l++) {
+        for (int s=0; s < SLOTS; s++) {
+            const Timer* ring = &slots[l][s];
+            if (ring->next == ring) {
+                continue;
+            }
+            cout << "L" << l << "[" << s << "]: ";
+            for (const Timer* timer = ring->next; timer != ring; timer = timer->next) {
+                cout << timer->expires << " <==> ";
+            }
+            cout << "SLOT" << endl;
+        }
+    }
+    cout << endl;
+}
+
+// Node of the priority queue using ordered linked list, used for comparison
+struct PQNode
+{
+    uint64_t expires;
+    int id;
+    PQNode* next;
+};
+
+// Priority queue using ordered linked list, as in priority_queue_using_ordered_linked_list.cpp
+struct OrderedListQueue
+{
+    PQNode* front = NULL;
+
+    ~OrderedListQueue()
+    {
+        while (front != NULL) {
+            PQNode* target = front;
+            front = front->next;
+            delete target;
+        }
+    }
+
+    void enqueue(uint64_t expires, int id)
+    {
+        PQNode* node = new PQNode{ expires, id, NULL };
+        PQNode** pos = &front;
+        while (*pos != NULL && (*pos)->expires <= expires) {
+            pos = &(*pos)->next;
+        }
+        node->next = *pos;
+        *pos = node;
+    }
+
+    bool cancel(int id)
+    {
+        for (PQNode** pos = &front; *pos != NULL; pos = &(*pos)->next) {
+            if ((*pos)->id == id) {
+                PQNode* target = *pos;
+                *pos = target->next;
+                delete target;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Dequeue all the entries expiring up to now
+    size_t expire(uint64_t now)
+    {
+        size_t fired = 0;
+        while (front != NULL && front->expires <= now) {
+            PQNode* target = front;
+            front = front->next;
+            delete target;
+            fired++;
+        }
+        return fired;
+    }
+};
+
+// Priority queue using ordered array, as in priority_queue_using_ordered_array.cpp
+// The earliest expiry is kept at the rear.
+struct OrderedArrayQueue
+{
+    std::vector<std::pair<uint64_t, int>> queue;
+
+    void enqueue(uint64_t expires, int id)
+    {
+        queue.push_back(std::make_pair(expires, id));
+        int pos = (int)queue.size() - 2;
+        for (; pos >= 0 && expires >= queue[pos].first; pos--) {
+            queue[pos + 1] = queue[pos];
+        }
+        queue[pos + 1] = std::make_pair(expires, id);
+    }
+
+    bool cancel(int id)
+    {
+        for (size_t i=0; i < queue.size(); i++) {
+            if (queue[i].second == id) {
+                queue.erase(queue.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t expire(uint64_t now)
+    {
+        size_t fired = 0;
+        while (!queue.empty() && queue.back().first <= now) {
+            queue.pop_back();
+            fired++;
+        }
+        return fired;
+    }
+};
+
+// Binary heap with lazy cancellation: a cancelled entry stays in the heap
+// and is skipped when it reaches the top
+struct HeapQueue
+{
+    std::priority_queue<std::pair<uint64_t, int>, std::vector<std::pair<uint64_t, int>>,
+                        std::greater<std::pair<uint64_t, int>>> heap;
+    std::vector<bool> cancelled;
+
+    HeapQueue(int timers) : cancelled(timers, false) {}
+
+    void enqueue(uint64_t expires, int id) { heap.push(std::make_pair(expires, id)); }
+
+    bool cancel(int id)
+    {
+        cancelled[id] = true;
+        return true;
+    }
+
+    size_t expire(uint64_t now)
+    {
+        size_t fired = 0;
+        while (!heap.empty() && heap.top().first <= now) {
+            fired += !cancelled[heap.top().second];
+            heap.pop();
+        }
+        return fired;
+    }
+};
+
+// Number of timers fired through the callback
+static size_t callbacks = 0;
+
+// Benchmark callback
+void count_callback(Timer*)
+{
+    callbacks++;
+}
+
+// Time a queue: schedule the timers, cancel every fourth one, then run
+// the clock until all have fired
+template<class Queue>
+void run_queue(const char* name, Queue& queue, const std::vector<uint64_t>& expiry, uint64_t horizon)
+{
+    int timers = (int)expiry.size();
+    auto start = chrono::steady_clock::now();
+    for (int i=0; i < timers; i++) {
+        queue.enqueue(expiry[i], i);
+    }
+    double schedule_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int i=0; i < timers; i += 4) {
+        queue.cancel(i);
+    }
+    double cancel_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    size_t fired = 0;
+    for (uint64_t now=1; now <= horizon; now++) {
+        fired += queue.expire(now);
+    }
+    double expire_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "  " << name << ": schedule " << schedule_ms * 1e6 / timers << " ns, cancel "
+         << cancel_ms * 1e6 / ((timers + 3) / 4) << " ns, expire " << expire_ms * 1e6 / fired
+         << " ns per timer (" << fired << " fired)" << endl;
+}
+
+// Time the timing wheel on the same workload
+void run_wheel(const std::vector<uint64_t>& expiry, uint64_t horizon)
+{
+    int timers = (int)expiry.size();
+    std::vector<Timer> pool(timers, Timer{ NULL, NULL, 0, count_callback });
+    TimingWheel* wheel = new TimingWheel();
+    callbacks = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (int i=0; i < timers; i++) {
+        wheel->schedule(&pool[i], expiry[i]);
+    }
+    double schedule_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int i=0; i < timers; i += 4) {
+        wheel->cancel(&pool[i]);
+    }
+    double cancel_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    wheel->advance(horizon);
+    double expire_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "  TimingWheel: schedule " << schedule_ms * 1e6 / timers << " ns, cancel "
+         << cancel_ms * 1e6 / ((timers + 3) / 4) << " ns, expire " << expire_ms * 1e6 / callbacks
+         << " ns per timer (" << callbacks << " fired)" << endl;
+    delete wheel;
+}
+
+// Compare the wheel against the priority queues with timers spread over the horizon
+void benchmark(int timers, uint64_t horizon, bool ordered_queues)
+{
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> expiry(timers);
+    for (int i=0; i < timers; i++) {
+        expiry[i] = 1 + rng() % horizon;
+    }
+
+    cout << "Benchmark with " << timers << " timers over " << horizon << " ticks" << endl;
+    run_wheel(expiry, horizon);
+    HeapQueue heap(timers);
+    run_queue("binary heap", heap, expiry, horizon);
+    if (ordered_queues) {
+        OrderedListQueue list;
+        run_queue("ordered linked list", list, expiry, horizon);
+        OrderedArrayQueue array;
+        run_queue("ordered array", array, expiry, horizon);
+    }
+    cout << endl;
+}
+
+// Demo timer carrying a request id
+struct Request
+{
+    Timer timer; // First member, so the timer address is the request address
+    int id;
+};
+
+// Demo callback
+void on_timeout(Timer* timer)
+{
+    Request* request = reinterpret_cast<Request*>(timer);
+    cout << "request " << request->id << " timed out at tick " << timer->expires << endl;
+}
+
+int main()
+{
+    // Create a timing wheel
+    TimingWheel wheel;
+
+    // Schedule timers at different levels
+    Request requests[5] = {};
+    uint64_t expiry[5] = { 3, 3, 300, 70000, 20 };
+    for (int i=0; i < 5; i++) {
+        requests[i].id = i + 1;
+        requests[i].timer.callback = on_timeout;
+        wheel.schedule(&requests[i].timer, expiry[i]);
+    }
+    wheel.display("schedule requests 1 .. 5 at ticks 3, 3, 300, 70000, 20");
+
+    // Cancel a timer
+    wheel.cancel(&requests[4].timer);
+    wheel.display("cancel request 5");
+
+    // Run the clock
+    size_t fired = wheel.advance(10);
+    cout << "advance(10) fired " << fired << " timers" << endl << endl;
+    fired = wheel.advance(300);
+    cout << "advance(300) fired " << fired << " timers" << endl;
+    wheel.display("after advance(300)");
+    wheel.advance(65300);
+    wheel.display("after advance(65300), request 4 cascaded from level 2 to level 1");
+    fired = wheel.advance(5000);
+    cout << "advance(5000) fired " << fired << " timers" << endl << endl;
+
+    benchmark(20000, 1 << 16, true);
+    benchmark(10000000, 1 << 20, false);
+}
@@ -0,0 +1,542 @@
+/**
+ * C++ example to demonstrate a Work-Stealing Deque (Chase-Lev deque)
+ *
+ * The deque of deque_using_circular_array.cpp, shaped for a work-stealing
+ * scheduler: one owner thread pushes and pops tasks at the bottom, like a
+ * stack, while any number of thief threads steal the oldest tasks from
+ * the top. The owner's operations need no CAS except when it races a thief
+ * for the last task, and thieves only CAS the top.
+ *
+ * Top and bottom are positions which only grow, masked into a circular
+ * array with a power-of-two size. When the array is full the owner copies
+ * the tasks into an array of twice the size. A thief may still read the
+ * old array, so the old arrays are only freed with the deque.
+ *
+ * The memory orderings follow "Correct and Efficient Work-Stealing for
+ * Weak Memory Models" (Le, Pop, Cohen, Zappa Nardelli, PPoPP 2013), with
+ * the release fence before publishing bottom folded into a release store.
+ *
+ * Compile with: g++ -std=c++17 -O2 -pthread work_stealing_deque.cpp
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+/**
+ * Work-Stealing Deque implementation using a growable Circular Array
+ * T must be trivially copyable, typically a task pointer.
+ */
+template<class T>
+class WorkStealingDeque
+{
+    /**
+     * Circular Array Representation
+     */
+    struct Array
+    {
+        int64_t size; // A power of two
+        std::atomic<T>* slots;
+
+        Array(int64_t size) : size(size), slots(new std::atomic<T>[size]) {}
+        ~Array() { delete[] slots; }
+
+        T get(int64_t position) const { return slots[position & (size - 1)].load(std::memory_order_relaxed); }
+        void put(int64_t position, T element) { slots[position & (size - 1)].store(element, std::memory_order_relaxed); }
+    };
+
+    // Next position to steal, advanced by thieves and by the owner
+    alignas(64) std::atomic<int64_t> top;
+
+    // Next position to push, written by the owner only
+    alignas(64) std::atomic<int64_t> bottom;
+
+    // Current array, and the older ones thieves may still read
+    std::atomic<Array*> array;
+    std::vector<Array*> retired;
+
+public:
+    // Constructor, with an initial capacity rounded up to a power of two
+    WorkStealingDeque(int64_t capacity = 64);
+
+    // Destructor, only once no other thread uses the deque
+    ~WorkStealingDeque();
+
+    // Insert the new element at the bottom, growing the array if full,
+    // owner only
+    void push(T element);
+
+    // Delete the element at the bottom, owner only
+    // Returns false if the deque is empty.
+    bool pop(T& element);
+
+    // Delete the element at the top, any thread
+    // Returns false if the deque is empty or another thread took the
+    // element first, in which case the thief may retry.
+    bool steal(T& element);
+
+    // Returns the number of elements, exact only when no other thread runs
+    int64_t size() const { return bottom.load() - top.load(); }
+
+    // Print the Deque, only while no other thread uses it
+    void display(const std::string& msg);
+
+private:
+    WorkStealingDeque(const WorkStealingDeque&);
+    WorkStealingDeque& operator=(const WorkStealingDeque&);
+
+    // Copy positions top..bottom into an array of twice the size
+    Array* grow(Array* old, int64_t top, int64_t bottom);
+};
+
+template<class T>
+WorkStealingDeque<T>::WorkStealingDeque(int64_t capacity) : top(0), bottom(0)
+{
+    int64_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    array.store(new Array(size));
+}
+
+template<class T>
+WorkStealingDeque<T>::~WorkStealingDeque()
+{
+    delete array.load();
+    for (size_t i=0; i < retired.size(); i++) {
+        delete retired[i];
+    }
+}
+
+template<class T>
+typename WorkStealingDeque<T>::Array* WorkStealingDeque<T>::grow(Array* old, int64_t top, int64_t bottom)
+{
+    Array* bigger = new Array(old->size * 2);
+    for (int64_t position=top; position < bottom; position++) {
+        bigger->put(position, old->get(position));
+    }
+    retired.push_back(old);
+    return bigger;
+}
+
+template<class T>
+void WorkStealingDeque<T>::push(T element)
+{
+    // Step 1. Grow the array if it is full
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    Array* a = array.load(std::memory_order_relaxed);
+    if (b - t > a->size - 1) {
+        a = grow(a, t, b);
+        array.store(a, std::memory_order_release);
+    }
+
+    // Step 2. Store the element, then publish it to thieves by moving bottom
+    a->put(b, element);
+    bottom.store(b + 1, std::memory_order_release);
+}
+
+template<class T>
+bool WorkStealingDeque<T>::pop(T& element)
+{
+    // Step 1. Reserve the bottom element by moving bottom first. The fence
+    // orders this store before reading top, so a thief either sees the new
+    // bottom or the owner sees the thief's new top.
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Array* a = array.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    // Step 2. Return if the Deque was empty, restoring bottom
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Step 3. Take the element. If it is the last one, race the thieves for
+    // it with a CAS on top, as they do.
+    element = a->get(b);
+    if (t == b) {
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+template<class T>
+bool WorkStealingDeque<T>::steal(T& element)
+{
+    // Step 1. Read top, then bottom, in this order for all threads
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return false;
+    }
+
+    // Step 2. Read the element, then claim it by moving top. If the CAS
+    // fails, another thief or the owner took it.
+    Array* a = array.load(std::memory_order_acquire);
+    T candidate = a->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return false;
+    }
+    element = candidate;
+    return true;
+}
+
+template<class T>
+void WorkStealingDeque<T>::display(const std::string& msg)
+{
+    cout << msg << endl;
+    int64_t t = top.load();
+    int64_t b = bottom.load();
+    if (t >= b) {
+        cout << "Deque is Empty" << endl;
+        return;
+    }
+
+    Array* a = array.load();
+    for (int64_t position=t; position < b; position++) {
+        cout << "[" << (position & (a->size - 1)) << "] " << a->get(position);
+        if (position == t) {
+            cout << " <-- top";
+        }
+        if (position == b - 1) {
+            cout << (position == t ? ", bottom" : " <-- bottom");
+        }
+        cout << endl;
+    }
+}
+
+// The owner pushes count elements, popping some back, while thieves
+// steal. Every element must be taken exactly once.
+// Returns true if the check passed.
+bool stress(int thieves, int count)
+{
+    WorkStealingDeque<int> deque(2);
+    std::vector<std::atomic<int>> taken(count);
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> pool;
+    for (int i=0; i < thieves; i++) {
+        pool.push_back(std::thread([&]() {
+            int element;
+            while (!done.load()) {
+                if (deque.steal(element)) {
+                    taken[element]++;
+                }
+            }
+        }));
+    }
+
+    int element;
+    for (int i=0; i < count; i++) {
+        deque.push(i);
+        if (i % 3 == 0 && deque.pop(element)) {
+            taken[element]++;
+        }
+    }
+    while (deque.pop(element)) {
+        taken[element]++;
+    }
+    done.store(true);
+    for (size_t t=0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+
+    for (int i=0; i < count; i++) {
+        if (taken[i] != 1) {
+            cout << "element " << i << " taken " << taken[i] << " times" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Fork-join task computing fib(n): it forks fib(n-1) and fib(n-2), and the
+ * last child to finish completes its parent (continuation passing, so no
+ * worker ever blocks on a join)
+ */
+struct Task
+{
+    int n;
+    Task* parent;
+    std::atomic<long long> result;
+    std::atomic<int> pending;
+};
+
+// Below this n a task computes fib serially
+#define SERIAL_CUTOFF 16
+
+long long fib(int n)
+{
+    return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+/**
+ * Fork-join scheduler: one deque per worker, idle workers steal from
+ * random victims
+ */
+class WorkStealingPool
+{
+    std::vector<WorkStealingDeque<Task*>*> deques;
+    std::atomic<bool> done;
+
+public:
+    // Compute fib(n) on the given number of workers
+    long long run(int workers, int n);
+
+private:
+    // Run a task on the worker's deque
+    void execute(Task* task, WorkStealingDeque<Task*>& own);
+
+    // Add a finished task's result to its parent, completing the parent
+    // when it was the last child
+    void complete(Task* task, long long result);
+};
+
+long long WorkStealingPool::run(int workers, int n)
+{
+    for (int i=0; i < workers; i++) {
+        deques.push_back(new WorkStealingDeque<Task*>());
+    }
+    done.store(false);
+
+    Task root;
+    root.n = n;
+    root.parent = NULL;
+    root.result.store(0);
+    root.pending.store(0);
+    long long result = 0;
+
+    auto worker = [&](int id) {
+        WorkStealingDeque<Task*>& own = *deques[id];
+        uint32_t random = id * 2654435761u + 1;
+        Task* task;
+        while (!done.load(std::memory_order_acquire)) {
+            // Step 1. Run our own tasks, the newest first
+            if (own.pop(task)) {
+                execute(task, own);
+                continue;
+            }
+
+            // Step 2. Otherwise steal the oldest task of a random victim
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+            int victim = random % workers;
+            if (victim != id && deques[victim]->steal(task)) {
+                execute(task, own);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    deques[0]->push(&root);
+    std::vector<std::thread> pool;
+    for (int i=1; i < workers; i++) {
+        pool.push_back(std::thread(worker, i));
+    }
+    worker(0);
+    for (size_t t=0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    result = root.result.load();
+
+    for (size_t i=0; i < deques.size(); i++) {
+        delete deques[i];
+    }
+    deques.clear();
+    return result;
+}
+
+void WorkStealingPool::execute(Task* task, WorkStealingDeque<Task*>& own)
+{
+    // Small tasks run serially
+    if (task->n < SERIAL_CUTOFF) {
+        complete(task, fib(task->n));
+        return;
+    }
+
+    // Fork both children, which complete this task when both are done
+    task->pending.store(2);
+    task->result.store(0);
+    for (int i=1; i <= 2; i++) {
+        Task* child = new Task;
+        child->n = task->n - i;
+        child->parent = task;
+        own.push(child);
+    }
+}
+
+void WorkStealingPool::complete(Task* task, long long result)
+{
+    for (;;) {
+        Task* parent = task->parent;
+        if (parent == NULL) {
+            // The root finished
+            task->result.store(result);
+            done.store(true, std::memory_order_release);
+            return;
+        }
+        delete task;
+
+        // Join: the last child to finish completes the parent
+        parent->result.fetch_add(result);
+        if (parent->pending.fetch_sub(1) != 1) {
+            return;
+        }
+        task = parent;
+        result = parent->result.load();
+    }
+}
+
+// Same fork-join scheduling on one deque shared by all the workers
+// behind a mutex, used for comparison
+class SharedQueuePool
+{
+    std::mutex lock;
+    std::deque<Task*> tasks;
+    std::atomic<bool> done;
+
+public:
+    long long run(int workers, int n)
+    {
+        done.store(false);
+        Task root;
+        root.n = n;
+        root.parent = NULL;
+        root.result.store(0);
+        root.pending.store(0);
+        tasks.push_back(&root);
+
+        auto worker = [&]() {
+            while (!done.load(std::memory_order_acquire)) {
+                Task* task = NULL;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (!tasks.empty()) {
+                        task = tasks.back();
+                        tasks.pop_back();
+                    }
+                }
+                if (task == NULL) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (task->n < SERIAL_CUTOFF) {
+                    complete(task, fib(task->n));
+                    continue;
+                }
+                task->pending.store(2);
+                task->result.store(0);
+                std::lock_guard<std::mutex> guard(lock);
+                for (int i=1; i <= 2; i++) {
+                    tasks.push_back(new Task{ task->n - i, task, { 0 }, { 0 } });
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (int i=1; i < workers; i++) {
+            pool.push_back(std::thread(worker));
+        }
+        worker();
+        for (size_t t=0; t < pool.size(); t++) {
+            pool[t].join();
+        }
+        return root.result.load();
+    }
+
+private:
+    void complete(Task* task, long long result)
+    {
+        for (;;) {
+            Task* parent = task->parent;
+            if (parent == NULL) {
+                task->result.store(result);
+                done.store(true, std::memory_order_release);
+                return;
+            }
+            delete task;
+            parent->result.fetch_add(result);
+            if (parent->pending.fetch_sub(1) != 1) {
+                return;
+            }
+            task = parent;
+            result = parent->result.load();
+        }
+    }
+};
+
+// The main function to begin the execution
+int main()
+{
+    // Create a Deque of 4 slots
+    WorkStealingDeque<int> deque(4);
+
+    // The owner pushes elements (10, 20, 30, 40 and 50), growing the array
+    deque.push(10);
+    deque.push(20);
+    deque.push(30);
+    deque.push(40);
+    deque.push(50);
+    deque.display("Deque after pushing 10 20 30 40 and 50");
+
+    // The owner pops the newest, a thief steals the oldest
+    int element;
+    deque.pop(element);
+    cout << "Pop element returned " << element << endl;
+    deque.steal(element);
+    cout << "Steal element returned " << element << endl;
+    deque.display("Deque after a pop and a steal");
+
+    // Stress test
+    for (int thieves=1; thieves <= 8; thieves *= 2) {
+        cout << "Stress test with " << thieves << " thieves: "
+             << (stress(thieves, 1000000) ? "every element taken once" : "FAILED") << endl;
+    }
+
+    // Fork-join benchmark, fib(38)
+    const int n = 38;
+    auto start = chrono::steady_clock::now();
+    long long expected = fib(n);
+    double serial_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << endl << "fib(" << n << ") = " << expected << ", serial " << serial_ms << " ms, "
+         << std::thread::hardware_concurrency() << " cores available" << endl;
+    cout << " WORKERS | WORK-STEALING MS | SHARED QUEUE MS" << endl;
+    cout << "---------+------------------+----------------" << endl;
+    for (int workers=1; workers <= 8; workers *= 2) {
+        WorkStealingPool stealing;
+        start = chrono::steady_clock::now();
+        long long result = stealing.run(workers, n);
+        double stealing_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        SharedQueuePool shared;
+        start = chrono::steady_clock::now();
+        long long shared_result = shared.run(workers, n);
+        double shared_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        cout.width(8);
+        cout << workers << " | ";
+        cout.width(16);
+        cout << stealing_ms << " | ";
+        cout.width(15);
+        cout << shared_ms;
+        if (result != expected || shared_result != expected) {
+            cout << "  WRONG RESULT";
+        }
+        cout << endl;
+    }
+}
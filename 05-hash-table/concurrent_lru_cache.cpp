@@ -0,0 +1,982 @@
+/**
+ * C++ example to demonstrate a sharded concurrent LRU cache
+ *
+ * The keys are spread over shards, each owning its own LRU lists and
+ * separate chaining hash table, so threads working on different shards
+ * never meet. Inside a shard:
+ *   - get() takes no lock. The index is read while writers change it: a
+ *     writer fills an entry before linking it with a release store, and
+ *     never changes a linked entry (an update links a new entry instead).
+ *   - A hit does not touch the LRU list; it pushes the entry into a lossy
+ *     read buffer. The buffers are replayed on the list in batches by
+ *     whichever thread holds the list lock next (the Caffeine approach).
+ *   - put() and remove() take the list lock, which serializes the writers
+ *     of a shard, and replay the read buffers.
+ *   - Readers are counted per stripe, a cache line shared only by the
+ *     threads mapped to it, in the counter of the current phase. An entry
+ *     unlinked in phase p is freed once the phase moved on and the counters
+ *     of phase p dropped to zero, since no reader can reach it any more.
+ *   - Optionally, W-TinyLFU admission: new entries enter a small window
+ *     LRU. An entry leaving the window only enters the main LRU if a
+ *     count-min sketch saw its key more often than the main LRU victim.
+ *
+ * Compile with: g++ -std=c++17 -O2 -pthread concurrent_lru_cache.cpp
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Number of reader stripes of a shard, a power of two
+#define READER_STRIPES 16
+
+// Number of slots of the read buffer of a stripe, a power of two
+#define READ_BUFFER 8
+
+// Number of reads of a stripe after which a reader tries to replay the buffers
+#define DRAIN_THRESHOLD 8
+
+// Number of rows of the count-min sketch
+#define SKETCH_DEPTH 4
+
+/**
+ * Cache entry
+ * The entry is linked on one LRU list of its shard and on its hash bucket.
+ */
+struct Entry
+{
+    std::string key;
+    std::string value;
+    uint64_t hash;
+    Entry* prev;               // Previous entry on the LRU list
+    Entry* next;               // Next entry on the LRU list, or on the retired list
+    std::atomic<Entry*> chain; // Next entry in the same hash bucket
+    bool in_main;              // True on the main LRU list, false on the window list
+    bool live;                 // False once evicted, removed or replaced
+};
+
+// Returns the hash of a key (FNV-1a)
+uint64_t hash_key(const std::string& key)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash ^ (hash >> 29);
+}
+
+/**
+ * Hash table using separate chaining, indexing the entries of a shard
+ * The chains run through the entries themselves. Changes are serialized by
+ * the caller, but get() may run at the same time: links are published with
+ * release stores, and an unlinked entry keeps its chain link so a reader
+ * standing on it can go on. For that reason the table never rehashes, it is
+ * sized for the capacity of the cache.
+ */
+class HashTable
+{
+    // Hash table
+    std::atomic<Entry*>* hash_table;
+
+    // Hash table size, a power of two
+    size_t size;
+
+public:
+    // Constructor, with a bucket for each of the given number of entries
+    HashTable(size_t entries);
+
+    // Destructor, the entries belong to the shard
+    ~HashTable() { delete[] hash_table; }
+
+    // Insert an entry whose key is not in the table
+    void insert(Entry* entry);
+
+    // Delete the entry from the table
+    void remove(Entry* entry);
+
+    // Put the new entry in place of the old one, which has the same key
+    void replace(Entry* old_entry, Entry* new_entry);
+
+    // Access the entry by key
+    // Returns the entry associated with the key, NULL otherwise.
+    Entry* get(const std::string& key, uint64_t hash) const;
+
+private:
+    // Returns the link pointing to the entry
+    std::atomic<Entry*>* link_of(Entry* entry);
+};
+
+HashTable::HashTable(size_t entries) : size(16)
+{
+    while (size < entries) {
+        size *= 2;
+    }
+    hash_table = new std::atomic<Entry*>[size];
+    for (size_t i=0; i < size; i++) {
+        hash_table[i].store(NULL, std::memory_order_relaxed);
+    }
+}
+
+void HashTable::insert(Entry* entry)
+{
+    // Insert the entry in the front side of chain, publishing it filled
+    std::atomic<Entry*>& bucket = hash_table[entry->hash & (size - 1)];
+    entry->chain.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    bucket.store(entry, std::memory_order_release);
+}
+
+std::atomic<Entry*>* HashTable::link_of(Entry* entry)
+{
+    // Find the link pointing to the entry in its chain
+    std::atomic<Entry*>* link = &hash_table[entry->hash & (size - 1)];
+    while (link->load(std::memory_order_relaxed) != entry) {
+        link = &link->load(std::memory_order_relaxed)->chain;
+    }
+    return link;
+}
+
+void HashTable::remove(Entry* entry)
+{
+    // Skip the entry, which keeps its own link for the readers on it
+    link_of(entry)->store(entry->chain.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+void HashTable::replace(Entry* old_entry, Entry* new_entry)
+{
+    new_entry->chain.store(old_entry->chain.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    link_of(old_entry)->store(new_entry, std::memory_order_release);
+}
+
+Entry* HashTable::get(const std::string& key, uint64_t hash) const
+{
+    // Traverse the chain starting from the index entry
+    Entry* p = hash_table[hash & (size - 1)].load(std::memory_order_acquire);
+    while (p != NULL) {
+        if (p->hash == hash && p->key == key) {
+            return p;
+        }
+        p = p->chain.load(std::memory_order_acquire);
+    }
+    return NULL;
+}
+
+/**
+ * Circular doubly linked list of entries, most recently used first
+ */
+struct LRUList
+{
+    Entry* head;  // Most recently used entry, head->prev is the least recently used
+    size_t count; // Number of entries
+
+    LRUList() : head(NULL), count(0) {}
+
+    // Returns the least recently used entry, NULL if empty
+    Entry* back() const { return head == NULL ? NULL : head->prev; }
+
+    // Link the entry in front of the list
+    void link_front(Entry* entry)
+    {
+        if (head == NULL) {
+            entry->prev = entry;
+            entry->next = entry;
+        } else {
+            entry->prev = head->prev;
+            entry->prev->next = entry;
+            entry->next = head;
+            entry->next->prev = entry;
+        }
+        head = entry;
+        count++;
+    }
+
+    // Unlink the entry from the list
+    void unlink(Entry* entry)
+    {
+        if (entry->next == entry) {
+            head = NULL;
+        } else {
+            entry->prev->next = entry->next;
+            entry->next->prev = entry->prev;
+            if (head == entry) {
+                head = entry->next;
+            }
+        }
+        count--;
+    }
+
+    // Move the entry to the front of the list
+    void move_front(Entry* entry)
+    {
+        if (entry != head) {
+            unlink(entry);
+            link_front(entry);
+        }
+    }
+
+    // Release all the entries
+    void clear()
+    {
+        while (head != NULL) {
+            Entry* target = head;
+            unlink(target);
+            delete target;
+        }
+    }
+};
+
+/**
+ * Count-min sketch estimating how often each key was accessed recently
+ * The counters saturate at 15, and all of them are halved once the sketch
+ * has counted ten times as many accesses as the cache holds entries, so
+ * old popularity fades away.
+ */
+class FrequencySketch
+{
+    // SKETCH_DEPTH rows of width counters
+    std::vector<uint8_t> table;
+    size_t width;
+
+    // Number of increments since the last halving, and the halving period
+    size_t additions;
+    size_t sample_size;
+
+public:
+    // Constructor
+    FrequencySketch(size_t entries);
+
+    // Count an access to the key
+    void increment(uint64_t hash);
+
+    // Returns the estimated access count of the key
+    int frequency(uint64_t hash) const;
+
+private:
+    // Returns the counter of the key in the given row
+    size_t index(uint64_t hash, int row) const
+    {
+        static const uint64_t seeds[SKETCH_DEPTH] = {
+            0xc3a5c85c97cb3127ull, 0xb492b66fbe98f273ull, 0x9ae16a3b2f90404full, 0xcbf29ce484222325ull
+        };
+        uint64_t h = (hash ^ seeds[row]) * 0x9e3779b97f4a7c15ull;
+        return row * width + ((h >> 32) & (width - 1));
+    }
+};
+
+FrequencySketch::FrequencySketch(size_t entries) : width(16), additions(0), sample_size(10 * std::max<size_t>(entries, 1))
+{
+    // Four counters per entry and row keep the collisions low over a sample
+    while (width < 4 * entries) {
+        width *= 2;
+    }
+    table.assign(SKETCH_DEPTH * width, 0);
+}
+
+void FrequencySketch::increment(uint64_t hash)
+{
+    // Step 1. Increment the counter of the key in every row
+    bool added = false;
+    for (int row=0; row < SKETCH_DEPTH; row++) {
+        uint8_t& counter = table[index(hash, row)];
+        if (counter < 15) {
+            counter++;
+            added = true;
+        }
+    }
+
+    // Step 2. Halve all the counters at the end of the sample period
+    if (added && ++additions == sample_size) {
+        for (uint8_t& counter : table) {
+            counter >>= 1;
+        }
+        additions /= 2;
+    }
+}
+
+int FrequencySketch::frequency(uint64_t hash) const
+{
+    // The smallest counter has the fewest collisions with other keys
+    int count = 15;
+    for (int row=0; row < SKETCH_DEPTH; row++) {
+        count = std::min<int>(count, table[index(hash, row)]);
+    }
+    return count;
+}
+
+/**
+ * Readers of a shard mapped to the same stripe, on their own cache lines
+ */
+struct alignas(64) ReaderStripe
+{
+    std::atomic<uint32_t> active[2];        // Readers inside get(), by phase parity
+    std::atomic<uint32_t> read_count;       // Hits recorded in the read buffer
+    uint32_t drained_count;                 // Value of read_count at the last replay, for the writers
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<Entry*> reads[READ_BUFFER]; // Lossy read buffer, each hit overwrites the next slot
+};
+
+/**
+ * One shard of the cache
+ */
+class alignas(64) Shard
+{
+    // Serializes the writers, and guards the LRU lists, the sketch and the
+    // retired lists
+    std::mutex list_lock;
+
+    // Index of the live entries by key
+    HashTable index;
+
+    // Window and main LRU lists with their capacities in entries
+    // Without admission, the window holds the whole capacity.
+    LRUList window;
+    LRUList main;
+    size_t window_capacity;
+    size_t main_capacity;
+
+    // Access frequency of the keys, NULL without admission
+    FrequencySketch* sketch;
+
+    // Entries unlinked in the current phase, and in the previous phase
+    Entry* retired;
+    Entry* retired_previous;
+
+    // Reclamation phase, only moved by the writers
+    alignas(64) std::atomic<uint64_t> phase;
+
+    // Reader counters and read buffers
+    ReaderStripe stripes[READER_STRIPES];
+
+public:
+    // Statistics kept by the writers
+    alignas(64) std::atomic<uint64_t> evictions;
+    std::atomic<uint64_t> rejections;
+
+    // Constructor
+    Shard(size_t capacity, bool admission);
+
+    // Destructor
+    ~Shard();
+
+    // Access the value of the key without taking a lock
+    // Returns true and sets the value if found, false otherwise.
+    bool get(const std::string& key, uint64_t hash, std::string& value);
+
+    // Insert or update the key-value pair
+    void put(const std::string& key, uint64_t hash, const std::string& value);
+
+    // Delete the key
+    // Returns true on success, false otherwise.
+    bool remove(const std::string& key, uint64_t hash);
+
+    // Returns the number of live entries
+    size_t size();
+
+    // Returns the number of get() calls which found the key, and which did not
+    uint64_t hit_count() const;
+    uint64_t miss_count() const;
+
+private:
+    // Replay the read buffers on the LRU lists, free the retired entries
+    // no reader can reach any more, and start a new phase if needed
+    // The list lock must be held.
+    void drain();
+
+    // Evict from the window and main lists until both fit their capacity
+    // The list lock must be held.
+    void evict();
+
+    // Unlink the entry from its list and the index, and retire it
+    // The list lock must be held.
+    void retire(Entry* entry);
+
+    // Keep the unlinked entry until no reader can hold it
+    // The list lock must be held.
+    void defer_free(Entry* entry);
+
+    // Returns the stripe of the calling thread; threads take the stripes in turn
+    static size_t stripe_index()
+    {
+        static std::atomic<size_t> next_stripe(0);
+        static thread_local size_t stripe = next_stripe.fetch_add(1) & (READER_STRIPES - 1);
+        return stripe;
+    }
+};
+
+Shard::Shard(size_t capacity, bool admission)
+    : index(capacity), sketch(NULL), retired(NULL), retired_previous(NULL), phase(0), evictions(0), rejections(0)
+{
+    // W-TinyLFU gives the window 1% of the capacity
+    capacity = std::max<size_t>(capacity, 2);
+    if (admission) {
+        window_capacity = std::max<size_t>(capacity / 100, 1);
+        main_capacity = capacity - window_capacity;
+        sketch = new FrequencySketch(capacity);
+    } else {
+        window_capacity = capacity;
+        main_capacity = 0;
+    }
+    for (int s=0; s < READER_STRIPES; s++) {
+        ReaderStripe& stripe = stripes[s];
+        stripe.active[0].store(0, std::memory_order_relaxed);
+        stripe.active[1].store(0, std::memory_order_relaxed);
+        stripe.read_count.store(0, std::memory_order_relaxed);
+        stripe.drained_count = 0;
+        stripe.hits.store(0, std::memory_order_relaxed);
+        stripe.misses.store(0, std::memory_order_relaxed);
+        for (int i=0; i < READ_BUFFER; i++) {
+            stripe.reads[i].store(NULL, std::memory_order_relaxed);
+        }
+    }
+}
+
+Shard::~Shard()
+{
+    // No reader is left, every entry can be freed
+    for (Entry* list : { retired, retired_previous }) {
+        while (list != NULL) {
+            Entry* target = list;
+            list = list->next;
+            delete target;
+        }
+    }
+    window.clear();
+    main.clear();
+    delete sketch;
+}
+
+bool Shard::get(const std::string& key, uint64_t hash, std::string& value)
+{
+    ReaderStripe& stripe = stripes[stripe_index()];
+
+    // Step 1. Count the reader in the current phase. If the phase moved on
+    // meanwhile, the writer may have missed the count: retry in the new one.
+    uint64_t current;
+    for (;;) {
+        current = phase.load();
+        stripe.active[current & 1].fetch_add(1);
+        if (phase.load() == current) {
+            break;
+        }
+        stripe.active[current & 1].fetch_sub(1, std::memory_order_release);
+    }
+
+    // Step 2. Look up the key, and record a hit in the read buffer of the stripe
+    Entry* entry = index.get(key, hash);
+    uint32_t reads = 0;
+    if (entry != NULL) {
+        value = entry->value;
+        reads = stripe.read_count.fetch_add(1, std::memory_order_relaxed);
+        stripe.reads[reads & (READ_BUFFER - 1)].store(entry, std::memory_order_release);
+        stripe.hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        stripe.misses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Step 3. Leave the phase. The release orders the buffered entry before it.
+    stripe.active[current & 1].fetch_sub(1, std::memory_order_release);
+    if (entry == NULL) {
+        return false;
+    }
+
+    // Step 4. Every DRAIN_THRESHOLD hits, replay the buffers if the list is free
+    if ((reads + 1) % DRAIN_THRESHOLD == 0 && list_lock.try_lock()) {
+        drain();
+        list_lock.unlock();
+    }
+    return true;
+}
+
+void Shard::drain()
+{
+    // Step 1. Check if the readers of the previous phase are all gone. They
+    // are the last ones which could reach the entries of retired_previous.
+    uint64_t current = phase.load(std::memory_order_relaxed);
+    bool quiescent = true;
+    for (int s=0; s < READER_STRIPES && quiescent; s++) {
+        quiescent = stripes[s].active[(current - 1) & 1].load() == 0;
+    }
+
+    // Step 2. Move every buffered entry which is still live to the front.
+    // Entries overwritten before the replay are simply lost. Stripes without
+    // a hit since the last replay are skipped, unless retired entries are
+    // about to be freed: a hit is counted before its slot is written, so a
+    // skipped stripe may still hold one of them.
+    bool full_scan = quiescent && retired_previous != NULL;
+    for (int s=0; s < READER_STRIPES; s++) {
+        ReaderStripe& stripe = stripes[s];
+        uint32_t reads = stripe.read_count.load(std::memory_order_relaxed);
+        if (reads == stripe.drained_count && !full_scan) {
+            continue;
+        }
+        stripe.drained_count = reads;
+        for (int i=0; i < READ_BUFFER; i++) {
+            std::atomic<Entry*>& slot = stripe.reads[i];
+            if (slot.load(std::memory_order_relaxed) == NULL) {
+                continue;
+            }
+            Entry* entry = slot.exchange(NULL, std::memory_order_acquire);
+            if (entry != NULL && entry->live) {
+                (entry->in_main ? main : window).move_front(entry);
+                if (sketch != NULL) {
+                    sketch->increment(entry->hash);
+                }
+            }
+        }
+    }
+    if (!quiescent) {
+        return;
+    }
+
+    // Step 3. Free the entries of the previous phase: their readers are gone
+    // and no buffer slot points to them any more
+    while (retired_previous != NULL) {
+        Entry* target = retired_previous;
+        retired_previous = retired_previous->next;
+        delete target;
+    }
+
+    // Step 4. Start a new phase for the entries retired in this one, so
+    // that the readers which may still reach them can be told apart
+    if (retired != NULL) {
+        retired_previous = retired;
+        retired = NULL;
+        phase.store(current + 1);
+    }
+}
+
+void Shard::put(const std::string& key, uint64_t hash, const std::string& value)
+{
+    std::lock_guard<std::mutex> guard(list_lock);
+    drain();
+    if (sketch != NULL) {
+        sketch->increment(hash);
+    }
+
+    // Step 1. Create the entry, filled before any reader can see it
+    Entry* entry = new Entry();
+    entry->key = key;
+    entry->value = value;
+    entry->hash = hash;
+    entry->live = true;
+
+    // Step 2. If the key exists, the new entry takes the place of the old
+    // one in the index and in its list. Readers may be copying the old
+    // value, so it is never changed in place.
+    Entry* old_entry = index.get(key, hash);
+    if (old_entry != NULL) {
+        entry->in_main = old_entry->in_main;
+        index.replace(old_entry, entry);
+        LRUList& list = old_entry->in_main ? main : window;
+        list.unlink(old_entry);
+        list.link_front(entry);
+        defer_free(old_entry);
+        return;
+    }
+
+    // Step 3. Otherwise insert the new entry in front of the window
+    index.insert(entry);
+    window.link_front(entry);
+
+    // Step 4. Make room
+    evict();
+}
+
+void Shard::evict()
+{
+    while (window.count > window_capacity) {
+        // Step 1. Without admission, the window is a plain LRU
+        Entry* candidate = window.back();
+        if (sketch == NULL) {
+            retire(candidate);
+            evictions++;
+            continue;
+        }
+
+        // Step 2. Move the window victim to the main list
+        window.unlink(candidate);
+        candidate->in_main = true;
+        main.link_front(candidate);
+        if (main.count <= main_capacity) {
+            continue;
+        }
+
+        // Step 3. The main list is full: keep the candidate only if its key
+        // is more popular than the least recently used entry of main
+        Entry* victim = main.back();
+        if (sketch->frequency(candidate->hash) > sketch->frequency(victim->hash)) {
+            retire(victim);
+            evictions++;
+        } else {
+            retire(candidate);
+            rejections++;
+        }
+    }
+}
+
+void Shard::retire(Entry* entry)
+{
+    // Step 1. Unlink the entry from its list
+    (entry->in_main ? main : window).unlink(entry);
+
+    // Step 2. Remove it from the index, so no new reader can find it
+    index.remove(entry);
+
+    // Step 3. Keep it until no reader can hold it
+    defer_free(entry);
+}
+
+void Shard::defer_free(Entry* entry)
+{
+    entry->live = false;
+    entry->next = retired;
+    retired = entry;
+}
+
+bool Shard::remove(const std::string& key, uint64_t hash)
+{
+    std::lock_guard<std::mutex> guard(list_lock);
+    drain();
+    Entry* entry = index.get(key, hash);
+    if (entry == NULL) {
+        return false;
+    }
+    retire(entry);
+    return true;
+}
+
+size_t Shard::size()
+{
+    std::lock_guard<std::mutex> guard(list_lock);
+    return window.count + main.count;
+}
+
+uint64_t Shard::hit_count() const
+{
+    uint64_t total = 0;
+    for (int s=0; s < READER_STRIPES; s++) {
+        total += stripes[s].hits.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Shard::miss_count() const
+{
+    uint64_t total = 0;
+    for (int s=0; s < READER_STRIPES; s++) {
+        total += stripes[s].misses.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * Sharded cache implementation
+ */
+class ShardedCache
+{
+    // Shards, their number is a power of two
+    std::vector<Shard*> shards;
+
+public:
+    // Constructor
+    // The capacity in entries is split evenly over the shards.
+    ShardedCache(size_t capacity, int shard_count, bool admission);
+
+    // Destructor
+    ~ShardedCache();
+
+    // Access the value of the key
+    // Returns true and sets the value if found, false otherwise.
+    bool get(const std::string& key, std::string& value);
+
+    // Insert or update the key-value pair
+    void put(const std::string& key, const std::string& value);
+
+    // Delete the key
+    // Returns true on success, false otherwise.
+    bool remove(const std::string& key);
+
+    // Returns the number of entries
+    size_t size();
+
+    // Returns the fraction of get() calls which found the key
+    double hit_ratio();
+
+    // Returns the number of entries evicted and the number of new entries
+    // refused by the admission filter
+    uint64_t evictions();
+    uint64_t rejections();
+
+private:
+    // Returns the shard of the key, chosen by the high bits of its hash
+    Shard& shard(uint64_t hash) { return *shards[(hash >> 40) & (shards.size() - 1)]; }
+};
+
+ShardedCache::ShardedCache(size_t capacity, int shard_count, bool admission)
+{
+    // Round the number of shards up to a power of two
+    size_t count = 1;
+    while (count < (size_t)shard_count) {
+        count *= 2;
+    }
+    for (size_t i=0; i < count; i++) {
+        shards.push_back(new Shard(capacity / count, admission));
+    }
+}
+
+ShardedCache::~ShardedCache()
+{
+    for (Shard* s : shards) {
+        delete s;
+    }
+}
+
+bool ShardedCache::get(const std::string& key, std::string& value)
+{
+    uint64_t hash = hash_key(key);
+    return shard(hash).get(key, hash, value);
+}
+
+void ShardedCache::put(const std::string& key, const std::string& value)
+{
+    uint64_t hash = hash_key(key);
+    shard(hash).put(key, hash, value);
+}
+
+bool ShardedCache::remove(const std::string& key)
+{
+    uint64_t hash = hash_key(key);
+    return shard(hash).remove(key, hash);
+}
+
+size_t ShardedCache::size()
+{
+    size_t total = 0;
+    for (Shard* s : shards) {
+        total += s->size();
+    }
+    return total;
+}
+
+double ShardedCache::hit_ratio()
+{
+    uint64_t hits = 0, misses = 0;
+    for (Shard* s : shards) {
+        hits += s->hit_count();
+        misses += s->miss_count();
+    }
+    return hits + misses == 0 ? 0 : (double)hits / (hits + misses);
+}
+
+uint64_t ShardedCache::evictions()
+{
+    uint64_t total = 0;
+    for (Shard* s : shards) {
+        total += s->evictions.load();
+    }
+    return total;
+}
+
+uint64_t ShardedCache::rejections()
+{
+    uint64_t total = 0;
+    for (Shard* s : shards) {
+        total += s->rejections.load();
+    }
+    return total;
+}
+
+/**
+ * LRU cache behind one mutex, used for comparison
+ */
+class MutexLRUCache
+{
+    std::mutex lock;
+    HashTable index;
+    LRUList list;
+    size_t capacity;
+    uint64_t hits;
+    uint64_t misses;
+
+public:
+    MutexLRUCache(size_t capacity) : index(capacity), capacity(capacity), hits(0), misses(0) {}
+
+    ~MutexLRUCache() { list.clear(); }
+
+    bool get(const std::string& key, std::string& value)
+    {
+        uint64_t hash = hash_key(key);
+        std::lock_guard<std::mutex> guard(lock);
+        Entry* entry = index.get(key, hash);
+        if (entry == NULL) {
+            misses++;
+            return false;
+        }
+        list.move_front(entry);
+        value = entry->value;
+        hits++;
+        return true;
+    }
+
+    void put(const std::string& key, const std::string& value)
+    {
+        uint64_t hash = hash_key(key);
+        std::lock_guard<std::mutex> guard(lock);
+        Entry* entry = index.get(key, hash);
+        if (entry != NULL) {
+            entry->value = value;
+            list.move_front(entry);
+            return;
+        }
+        entry = new Entry();
+        entry->key = key;
+        entry->value = value;
+        entry->hash = hash;
+        index.insert(entry);
+        list.link_front(entry);
+        if (list.count > capacity) {
+            Entry* target = list.back();
+            list.unlink(target);
+            index.remove(target);
+            delete target;
+        }
+    }
+
+    double hit_ratio() { return hits + misses == 0 ? 0 : (double)hits / (hits + misses); }
+};
+
+// Returns a trace of key ids drawn from a Zipf distribution over [0, keys)
+// Key i is requested with probability proportional to 1 / (i+1)^skew.
+std::vector<int> zipf_trace(int keys, double skew, int length, unsigned int seed)
+{
+    // Step 1. Build the cumulative distribution
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (int i=0; i < keys; i++) {
+        sum += 1.0 / std::pow(i + 1, skew);
+        cdf[i] = sum;
+    }
+
+    // Step 2. Draw uniform numbers and find their key by binary search
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0, sum);
+    std::vector<int> trace(length);
+    for (int i=0; i < length; i++) {
+        int rank = (int)(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+        trace[i] = (int)(((unsigned int)rank * 2654435761u) % (unsigned int)keys);
+    }
+    return trace;
+}
+
+// Replay the traces on the cache, one thread per trace: get every key
+// and put it on a miss
+// Returns the throughput in requests per second
+template<class Cache>
+long long run(Cache& cache, const std::vector<std::string>& keys, const std::vector<std::vector<int>>& traces)
+{
+    auto worker = [&](int t) {
+        std::string value;
+        std::string payload(100, 'v');
+        for (int id : traces[t]) {
+            if (!cache.get(keys[id], value)) {
+                cache.put(keys[id], payload);
+            }
+        }
+    };
+
+    auto start = chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (size_t t=0; t < traces.size(); t++) {
+        pool.push_back(std::thread(worker, (int)t));
+    }
+    for (size_t t=0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return (long long)(traces.size() * traces[0].size() / ms * 1000);
+}
+
+// Compare the throughput and hit ratio of the caches on Zipf traces
+void benchmark(int keys, int requests)
+{
+    std::vector<std::string> names(keys);
+    for (int i=0; i < keys; i++) {
+        names[i] = "key:" + std::to_string(i);
+    }
+    size_t capacity = keys / 20;
+
+    cout << "Replay of " << requests << " requests over " << keys << " Zipf(0.99) keys, cache of "
+         << capacity << " entries" << endl;
+    cout << " THREADS | MUTEX LRU REQ/SEC (HIT) | SHARDED LRU REQ/SEC (HIT) | SHARDED W-TINYLFU REQ/SEC (HIT)" << endl;
+    cout << "---------+-------------------------+---------------------------+--------------------------------" << endl;
+    for (int threads=1; threads <= 8; threads *= 2) {
+        std::vector<std::vector<int>> traces;
+        for (int t=0; t < threads; t++) {
+            traces.push_back(zipf_trace(keys, 0.99, requests / threads, 42 + t));
+        }
+
+        MutexLRUCache mutex_cache(capacity);
+        ShardedCache lru_cache(capacity, 16, false);
+        ShardedCache tinylfu_cache(capacity, 16, true);
+        long long mutex_rate = run(mutex_cache, names, traces);
+        long long lru_rate = run(lru_cache, names, traces);
+        long long tinylfu_rate = run(tinylfu_cache, names, traces);
+
+        cout.precision(3);
+        cout.width(8);
+        cout << threads << " | ";
+        cout.width(14);
+        cout << mutex_rate << " (" << mutex_cache.hit_ratio() << ") | ";
+        cout.width(16);
+        cout << lru_rate << " (" << lru_cache.hit_ratio() << ") | ";
+        cout.width(21);
+        cout << tinylfu_rate << " (" << tinylfu_cache.hit_ratio() << ")" << endl;
+    }
+}
+
+int main()
+{
+    // Create a cache of 4 shards with room for 400 entries and admission
+    ShardedCache cache(400, 4, true);
+
+    // Insert key-value pairs
+    cache.put("Alice", "101");
+    cache.put("Bell", "102");
+    cache.put("Max", "103");
+
+    std::string value;
+    cache.get("Bell", value);
+    cout << "get('Bell') returns " << value << endl;
+    cout << "get('Evin') returns " << cache.get("Evin", value) << endl;
+    cout << "remove('Max') returns " << cache.remove("Max") << endl;
+    cout << "size() returns " << cache.size() << endl << endl;
+
+    // A scan of one-time keys cannot flush the popular keys out
+    for (int round=0; round < 20; round++) {
+        for (int i=0; i < 50; i++) {
+            std::string key = "hot:" + std::to_string(i);
+            if (!cache.get(key, value)) {
+                cache.put(key, "h");
+            }
+        }
+    }
+    for (int i=0; i < 10000; i++) {
+        cache.put("scan:" + std::to_string(i), "s");
+    }
+    int kept = 0;
+    for (int i=0; i < 50; i++) {
+        kept += cache.get("hot:" + std::to_string(i), value);
+    }
+    cout << "after a scan of 10000 keys, " << kept << " of 50 hot keys are cached ("
+         << cache.rejections() << " new entries rejected, " << cache.evictions() << " evicted)" << endl << endl;
+
+    benchmark(100000, 2000000);
+}
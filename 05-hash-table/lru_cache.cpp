@@ -0,0 +1,797 @@
+/**
+ * C++ example to demonstrate the LRU and CLOCK caches
+ *
+ * Both caches find their entries through a separate chaining hash table
+ * and bound their size in bytes. The LRU cache keeps the entries on a
+ * circular doubly linked list, most recently used first: a hit moves the
+ * entry to the front and the eviction takes the last one, both in O(1).
+ * The CLOCK cache keeps them on a circular singly linked list instead.
+ * A hit only sets the reference bit of the entry, and the eviction hand
+ * sweeps the circle, giving every referenced entry a second chance.
+ * A removed entry cannot be unlinked without its predecessor, so it stays
+ * on the circle until the hand reaches it, or until the removed entries
+ * outnumber the live ones and one pass over the circle unlinks them all.
+ *
+ * Compile with: g++ -std=c++17 -O2 lru_cache.cpp
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <malloc.h>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+// One of every LATENCY_SAMPLE operations is timed, must be a power of two
+#define LATENCY_SAMPLE 64
+
+/**
+ * Cache entry
+ * The entry is linked on the list of its cache and on its hash bucket.
+ */
+struct Entry
+{
+    std::string key;
+    std::string value;
+    Entry* prev;     // Previous entry on the list, unused by CLOCK
+    Entry* next;     // Next entry on the list
+    Entry* chain;    // Next entry in the same hash bucket
+    bool referenced; // CLOCK reference bit
+    bool live;       // False once removed, CLOCK frees it lazily
+};
+
+// Returns the bytes charged for an entry
+size_t entry_bytes(const Entry* entry)
+{
+    return sizeof(Entry) + entry->key.size() + entry->value.size();
+}
+
+// Called with the key and value of every entry evicted for room
+typedef std::function<void(const std::string& key, const std::string& value)> EvictCallback;
+
+// Sampled latency of one kind of operation
+struct Latency
+{
+    uint64_t samples;
+    double total_ns;
+    double max_ns;
+
+    // Returns the average latency in nanoseconds
+    double average() const { return samples == 0 ? 0 : total_ns / samples; }
+};
+
+// Cache statistics
+struct CacheStats
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t puts;
+    uint64_t evictions;
+    Latency get_latency;
+    Latency put_latency;
+
+    // Returns the fraction of get() calls which found the key
+    double hit_ratio() const { return hits + misses == 0 ? 0 : (double)hits / (hits + misses); }
+};
+
+/**
+ * Times an operation for its whole scope if it is picked by the sampling
+ */
+class LatencyTimer
+{
+    Latency& latency;
+    bool sampled;
+    chrono::steady_clock::time_point start;
+
+public:
+    LatencyTimer(Latency& latency, uint64_t op) : latency(latency), sampled((op & (LATENCY_SAMPLE - 1)) == 0)
+    {
+        if (sampled) {
+            start = chrono::steady_clock::now();
+        }
+    }
+
+    ~LatencyTimer()
+    {
+        if (sampled) {
+            double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            latency.samples++;
+            latency.total_ns += ns;
+            latency.max_ns = std::max(latency.max_ns, ns);
+        }
+    }
+};
+
+/**
+ * Hash table using separate chaining, indexing the cache entries by key
+ * The chains run through the entries themselves, and the table doubles
+ * when it holds more entries than buckets.
+ */
+class HashTable
+{
+    // Hash table
+    Entry** hash_table;
+
+    // Hash table size, a power of two
+    size_t size;
+
+    // Number of entries
+    size_t count;
+
+public:
+    // Constructor
+    HashTable();
+
+    // Destructor
+    ~HashTable();
+
+    // Insert an entry whose key is not in the table
+    void insert(Entry* entry);
+
+    // Delete the entry from the table
+    void remove(Entry* entry);
+
+    // Access the entry by key
+    // Returns the entry associated with the key, NULL otherwise.
+    Entry* get(const std::string& key) const;
+
+private:
+    // Hash function to determine the index for every key
+    static size_t hash(const std::string& key);
+
+    // Double the table size and rehash the entries
+    void grow();
+};
+
+HashTable::HashTable() : size(16), count(0)
+{
+    hash_table = new Entry*[size]();
+}
+
+HashTable::~HashTable()
+{
+    // The entries belong to the cache, only the table is released
+    delete[] hash_table;
+}
+
+size_t HashTable::hash(const std::string& key)
+{
+    // FNV-1a, spreads similar keys over all the buckets
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return (size_t)(hash ^ (hash >> 32));
+}
+
+void HashTable::insert(Entry* entry)
+{
+    // Step 1. Grow the table if it is full
+    if (count >= size) {
+        grow();
+    }
+
+    // Step 2. Insert the entry in the front side of chain
+    size_t index = hash(entry->key) & (size - 1);
+    entry->chain = hash_table[index];
+    hash_table[index] = entry;
+    count++;
+}
+
+void HashTable::remove(Entry* entry)
+{
+    // Find the link pointing to the entry in its chain and skip the entry
+    size_t index = hash(entry->key) & (size - 1);
+    for (Entry** link = &hash_table[index]; *link != NULL; link = &(*link)->chain) {
+        if (*link == entry) {
+            *link = entry->chain;
+            count--;
+            return;
+        }
+    }
+}
+
+Entry* HashTable::get(const std::string& key) const
+{
+    // Traverse the chain starting from the index entry
+    for (Entry* p = hash_table[hash(key) & (size - 1)]; p != NULL; p = p->chain) {
+        if (p->key == key) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+void HashTable::grow()
+{
+    // Move every entry to its bucket in a table twice as large
+    size_t new_size = size * 2;
+    Entry** new_table = new Entry*[new_size]();
+    for (size_t i=0; i < size; i++) {
+        Entry* p = hash_table[i];
+        while (p != NULL) {
+            Entry* next = p->chain;
+            size_t index = hash(p->key) & (new_size - 1);
+            p->chain = new_table[index];
+            new_table[index] = p;
+            p = next;
+        }
+    }
+    delete[] hash_table;
+    hash_table = new_table;
+    size = new_size;
+}
+
+/**
+ * LRU cache implementation on a circular doubly linked list
+ */
+class LRUCache
+{
+    // Most recently used entry, its prev is the least recently used one
+    Entry* head;
+
+    // Index of the entries by key
+    HashTable index;
+
+    // Maximum and current bytes of the entries
+    size_t capacity;
+    size_t bytes;
+
+    // Called for every entry evicted for room
+    EvictCallback on_evict;
+
+    // Statistics
+    CacheStats stats;
+
+public:
+    // Constructor
+    LRUCache(size_t capacity, EvictCallback on_evict = NULL);
+
+    // Destructor
+    ~LRUCache();
+
+    // Access the value of the key and mark it most recently used
+    // Returns true and sets the value if found, false otherwise.
+    bool get(const std::string& key, std::string& value);
+
+    // Insert or update the key-value pair as the most recently used,
+    // evicting the least recently used entries while over capacity
+    void put(const std::string& key, const std::string& value);
+
+    // Delete the key without calling the eviction callback
+    // Returns true on success, false otherwise.
+    bool remove(const std::string& key);
+
+    // Returns the bytes of the entries
+    size_t size_bytes() const { return bytes; }
+
+    // Returns the statistics
+    const CacheStats& statistics() const { return stats; }
+
+    // Print the entries from the most to the least recently used
+    void display(const std::string& msg) const;
+
+private:
+    // Link the entry in front of the list
+    void link_front(Entry* entry);
+
+    // Unlink the entry from the list
+    void unlink(Entry* entry);
+};
+
+LRUCache::LRUCache(size_t capacity, EvictCallback on_evict)
+    : head(NULL), capacity(capacity), bytes(0), on_evict(on_evict), stats()
+{
+}
+
+LRUCache::~LRUCache()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (head == NULL) {
+        return;
+    }
+
+    // Step 2. Break the circle after the last entry and release the entries
+    head->prev->next = NULL;
+    while (head != NULL) {
+        Entry* target = head;
+        head = head->next;
+        delete target;
+    }
+}
+
+void LRUCache::link_front(Entry* entry)
+{
+    // Step 1. Check if the list is empty. If true, form the one entry circle.
+    if (head == NULL) {
+        entry->prev = entry;
+        entry->next = entry;
+    } else {
+        // Step 2. Otherwise connect the entry between the last entry and head
+        entry->prev = head->prev;
+        entry->prev->next = entry;
+        entry->next = head;
+        entry->next->prev = entry;
+    }
+
+    // Step 3. Make the entry as head
+    head = entry;
+}
+
+void LRUCache::unlink(Entry* entry)
+{
+    // Step 1. Check if the entry is the only one. If true, empty the list.
+    if (entry->next == entry) {
+        head = NULL;
+        return;
+    }
+
+    // Step 2. Connect the neighbours directly and move the head if needed
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    if (head == entry) {
+        head = entry->next;
+    }
+}
+
+bool LRUCache::get(const std::string& key, std::string& value)
+{
+    LatencyTimer timer(stats.get_latency, stats.hits + stats.misses);
+
+    // Step 1. Look up the key. Return if not found.
+    Entry* entry = index.get(key);
+    if (entry == NULL) {
+        stats.misses++;
+        return false;
+    }
+
+    // Step 2. Move the entry to the front
+    if (entry != head) {
+        unlink(entry);
+        link_front(entry);
+    }
+    stats.hits++;
+    value = entry->value;
+    return true;
+}
+
+void LRUCache::put(const std::string& key, const std::string& value)
+{
+    LatencyTimer timer(stats.put_latency, stats.puts++);
+
+    // Step 1. Update the entry if the key exists, or insert a new one
+    Entry* entry = index.get(key);
+    if (entry != NULL) {
+        bytes -= entry_bytes(entry);
+        entry->value = value;
+        unlink(entry);
+    } else {
+        entry = new Entry();
+        entry->key = key;
+        entry->value = value;
+        index.insert(entry);
+    }
+    bytes += entry_bytes(entry);
+    link_front(entry);
+
+    // Step 2. Evict the least recently used entries while over capacity,
+    // but always keep the new entry
+    while (bytes > capacity && head->prev != entry) {
+        Entry* target = head->prev;
+        unlink(target);
+        index.remove(target);
+        bytes -= entry_bytes(target);
+        stats.evictions++;
+        if (on_evict) {
+            on_evict(target->key, target->value);
+        }
+        delete target;
+    }
+}
+
+bool LRUCache::remove(const std::string& key)
+{
+    Entry* entry = index.get(key);
+    if (entry == NULL) {
+        return false;
+    }
+    unlink(entry);
+    index.remove(entry);
+    bytes -= entry_bytes(entry);
+    delete entry;
+    return true;
+}
+
+void LRUCache::display(const std::string& msg) const
+{
+    cout << msg << endl;
+    cout << "MRU --> ";
+    // Iterate the list from the most to the least recently used
+    Entry* p = head;
+    if (p != NULL) {
+        do {
+            cout << "[ " << p->key << " | " << p->value << " ] --> ";
+            p = p->next;
+        } while (p != head);
+    }
+    cout << "LRU (" << bytes << " of " << capacity << " bytes)" << endl << endl;
+}
+
+/**
+ * CLOCK cache implementation on a circular singly linked list
+ */
+class ClockCache
+{
+    // Entry under the clock hand and the entry before it
+    Entry* hand;
+    Entry* hand_prev;
+
+    // Index of the live entries by key
+    HashTable index;
+
+    // Maximum and current bytes of the live entries
+    size_t capacity;
+    size_t bytes;
+
+    // Number of live entries, and of removed entries still on the circle
+    size_t count;
+    size_t dead;
+
+    // Called for every entry evicted for room
+    EvictCallback on_evict;
+
+    // Statistics
+    CacheStats stats;
+
+public:
+    // Constructor
+    ClockCache(size_t capacity, EvictCallback on_evict = NULL);
+
+    // Destructor
+    ~ClockCache();
+
+    // Access the value of the key and set its reference bit
+    // Returns true and sets the value if found, false otherwise.
+    bool get(const std::string& key, std::string& value);
+
+    // Insert or update the key-value pair, evicting the entries found
+    // unreferenced by the clock hand while over capacity
+    void put(const std::string& key, const std::string& value);
+
+    // Delete the key without calling the eviction callback
+    // The entry stays on the circle until the hand reaches it, or until
+    // the removed entries outnumber the live ones.
+    // Returns true on success, false otherwise.
+    bool remove(const std::string& key);
+
+    // Returns the bytes of the live entries
+    size_t size_bytes() const { return bytes; }
+
+    // Returns the statistics
+    const CacheStats& statistics() const { return stats; }
+
+    // Print the entries starting at the clock hand, * marks the reference bit
+    void display(const std::string& msg) const;
+
+private:
+    // Walk the circle once and unlink every removed entry
+    void purge();
+};
+
+ClockCache::ClockCache(size_t capacity, EvictCallback on_evict)
+    : hand(NULL), hand_prev(NULL), capacity(capacity), bytes(0), count(0), dead(0), on_evict(on_evict), stats()
+{
+}
+
+ClockCache::~ClockCache()
+{
+    // Step 1. Check if the list is empty and return if true.
+    if (hand == NULL) {
+        return;
+    }
+
+    // Step 2. Break the circle before the hand and release the entries
+    hand_prev->next = NULL;
+    while (hand != NULL) {
+        Entry* target = hand;
+        hand = hand->next;
+        delete target;
+    }
+}
+
+bool ClockCache::get(const std::string& key, std::string& value)
+{
+    LatencyTimer timer(stats.get_latency, stats.hits + stats.misses);
+
+    // Step 1. Look up the key. Return if not found.
+    Entry* entry = index.get(key);
+    if (entry == NULL) {
+        stats.misses++;
+        return false;
+    }
+
+    // Step 2. Set the reference bit, the entry does not move
+    entry->referenced = true;
+    stats.hits++;
+    value = entry->value;
+    return true;
+}
+
+void ClockCache::put(const std::string& key, const std::string& value)
+{
+    LatencyTimer timer(stats.put_latency, stats.puts++);
+
+    // Step 1. Update the entry if the key exists
+    Entry* entry = index.get(key);
+    if (entry != NULL) {
+        bytes -= entry_bytes(entry);
+        entry->value = value;
+        entry->referenced = true;
+        bytes += entry_bytes(entry);
+    } else {
+        // Step 2. Otherwise link a new entry just behind the hand, so it is
+        // the last one the hand visits
+        entry = new Entry();
+        entry->key = key;
+        entry->value = value;
+        entry->live = true;
+        if (hand == NULL) {
+            entry->next = entry;
+            hand = entry;
+        } else {
+            hand_prev->next = entry;
+            entry->next = hand;
+        }
+        hand_prev = entry;
+        index.insert(entry);
+        bytes += entry_bytes(entry);
+        count++;
+    }
+
+    // Step 3. Sweep the hand while over capacity. A referenced entry loses
+    // its bit and survives this round, an unreferenced or removed one is
+    // unlinked. The entry just put is passed over and never evicted.
+    while (bytes > capacity && !(hand == entry && entry->next == entry)) {
+        Entry* target = hand;
+        if (target == entry || (target->live && target->referenced)) {
+            target->referenced = false;
+            hand_prev = target;
+            hand = target->next;
+            continue;
+        }
+
+        hand_prev->next = target->next;
+        hand = target->next;
+        if (target->live) {
+            index.remove(target);
+            bytes -= entry_bytes(target);
+            count--;
+            stats.evictions++;
+            if (on_evict) {
+                on_evict(target->key, target->value);
+            }
+        } else {
+            dead--;
+        }
+        delete target;
+    }
+}
+
+bool ClockCache::remove(const std::string& key)
+{
+    Entry* entry = index.get(key);
+    if (entry == NULL) {
+        return false;
+    }
+    // Step 1. Drop the entry from the index and the accounting, and
+    // release its strings right away
+    index.remove(entry);
+    bytes -= entry_bytes(entry);
+    entry->live = false;
+    std::string().swap(entry->key);
+    std::string().swap(entry->value);
+    count--;
+    dead++;
+
+    // Step 2. Unlink all the removed entries once they outnumber the live
+    // ones, so the pass costs O(1) per removal and the circle stays at
+    // most twice the live entries
+    if (dead > count) {
+        purge();
+    }
+    return true;
+}
+
+void ClockCache::purge()
+{
+    // Visit every entry once, starting at the hand, keeping prev the last
+    // entry left on the circle
+    Entry* prev = hand_prev;
+    size_t total = count + dead;
+    for (size_t i=0; i < total; i++) {
+        Entry* target = prev->next;
+        if (target->live) {
+            prev = target;
+            continue;
+        }
+
+        // Check if the target is the last entry on the circle. If true, empty it.
+        if (target == prev) {
+            hand = NULL;
+            hand_prev = NULL;
+            delete target;
+            break;
+        }
+        prev->next = target->next;
+        if (target == hand) {
+            hand = target->next;
+        }
+        if (target == hand_prev) {
+            hand_prev = prev;
+        }
+        delete target;
+    }
+    dead = 0;
+}
+
+void ClockCache::display(const std::string& msg) const
+{
+    cout << msg << endl;
+    cout << "HAND --> ";
+    // Iterate the circle once starting at the hand
+    Entry* p = hand;
+    if (p != NULL) {
+        do {
+            if (p->live) {
+                cout << "[ " << p->key << (p->referenced ? "*" : "") << " | " << p->value << " ] --> ";
+            }
+            p = p->next;
+        } while (p != hand);
+    }
+    cout << "HAND (" << bytes << " of " << capacity << " bytes)" << endl << endl;
+}
+
+// Returns a trace of key ids drawn from a Zipf distribution over [0, keys)
+// Key i is requested with probability proportional to 1 / (i+1)^skew.
+std::vector<int> zipf_trace(int keys, double skew, int length, unsigned int seed)
+{
+    // Step 1. Build the cumulative distribution
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (int i=0; i < keys; i++) {
+        sum += 1.0 / std::pow(i + 1, skew);
+        cdf[i] = sum;
+    }
+
+    // Step 2. Draw uniform numbers and find their key by binary search.
+    // The ids are scattered so popular keys do not share a hash bucket.
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0, sum);
+    std::vector<int> trace(length);
+    for (int i=0; i < length; i++) {
+        int rank = (int)(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+        trace[i] = (int)(((unsigned int)rank * 2654435761u) % (unsigned int)keys);
+    }
+    return trace;
+}
+
+// Replay the trace on the cache: get every key and put it on a miss
+template<class Cache>
+double replay(Cache& cache, const std::vector<std::string>& keys, const std::vector<int>& trace)
+{
+    std::string value;
+    std::string payload(100, 'v');
+    auto start = chrono::steady_clock::now();
+    for (int id : trace) {
+        if (!cache.get(keys[id], value)) {
+            cache.put(keys[id], payload);
+        }
+    }
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / trace.size();
+}
+
+// Compare LRU and CLOCK on a Zipf trace at several cache sizes
+void benchmark(int keys, int length)
+{
+    std::vector<std::string> names(keys);
+    for (int i=0; i < keys; i++) {
+        names[i] = "key:" + std::to_string(i);
+    }
+    std::vector<int> trace = zipf_trace(keys, 0.99, length, 42);
+
+    cout << "Replay of " << length << " requests over " << keys << " Zipf(0.99) keys, 100 byte values" << endl;
+    size_t entry_size = sizeof(Entry) + names[keys / 2].size() + 100;
+    for (int percent : { 1, 5, 20 }) {
+        size_t capacity = entry_size * keys * percent / 100;
+        LRUCache lru(capacity);
+        ClockCache clock(capacity);
+        double lru_ns = replay(lru, names, trace);
+        double clock_ns = replay(clock, names, trace);
+
+        const CacheStats& a = lru.statistics();
+        const CacheStats& b = clock.statistics();
+        cout << "  cache of " << percent << "% keys:" << endl;
+        cout << "    LRU   hit ratio " << a.hit_ratio() << ", " << lru_ns << " ns/request, get avg "
+             << a.get_latency.average() << " ns max " << a.get_latency.max_ns << " ns, put avg "
+             << a.put_latency.average() << " ns, " << a.evictions << " evictions" << endl;
+        cout << "    CLOCK hit ratio " << b.hit_ratio() << ", " << clock_ns << " ns/request, get avg "
+             << b.get_latency.average() << " ns max " << b.get_latency.max_ns << " ns, put avg "
+             << b.put_latency.average() << " ns, " << b.evictions << " evictions" << endl;
+    }
+}
+
+// Returns the number of bytes currently allocated from the heap
+size_t heap_in_use()
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// Put then remove the given number of distinct keys on a CLOCK cache
+// Returns the growth of the heap in bytes after the first thousand keys
+long long churn_heap_growth(int keys)
+{
+    ClockCache cache(100000);
+    std::string payload(100, 'v');
+    long long before = 0;
+    for (int i=0; i < keys; i++) {
+        std::string key = "key:" + std::to_string(i);
+        cache.put(key, payload);
+        cache.remove(key);
+        if (i == 1000) {
+            before = (long long)heap_in_use();
+        }
+    }
+    return (long long)heap_in_use() - before;
+}
+
+int main()
+{
+    // Room for three entries with single character values
+    size_t capacity = 3 * (sizeof(Entry) + 6);
+
+    // Create the LRU cache, reporting the evicted entries
+    LRUCache lru(capacity, [](const std::string& key, const std::string& value) {
+        cout << "evicted [ " << key << " | " << value << " ]" << endl;
+    });
+    lru.put("Alice", "1");
+    lru.put("Bell", "2");
+    lru.put("Max", "3");
+    lru.display("LRU after put of 'Alice', 'Bell' and 'Max'");
+
+    std::string value;
+    lru.get("Alice", value);
+    lru.display("LRU after get('Alice') returned " + value);
+
+    lru.put("Evin", "4");
+    lru.display("LRU after put('Evin')");
+
+    lru.remove("Max");
+    lru.display("LRU after remove('Max')");
+
+    // Create the CLOCK cache with the same capacity
+    ClockCache clock(capacity, [](const std::string& key, const std::string& value) {
+        cout << "evicted [ " << key << " | " << value << " ]" << endl;
+    });
+    clock.put("Alice", "1");
+    clock.put("Bell", "2");
+    clock.put("Max", "3");
+    clock.get("Alice", value);
+    clock.display("CLOCK after put of 'Alice', 'Bell' and 'Max', and get('Alice')");
+
+    clock.put("Evin", "4");
+    clock.display("CLOCK after put('Evin')");
+
+    clock.remove("Evin");
+    clock.display("CLOCK after remove('Evin')");
+
+    // Removed entries must not pile up on the circle
+    cout << "Heap growth after put and remove of 1M distinct keys on a 100 KB CLOCK cache: "
+         << churn_heap_growth(1000000) << " bytes" << endl << endl;
+
+    benchmark(100000, 2000000);
+}